@@ -84,6 +84,9 @@
 
 #include "cy_utils.h"
 
+/* Build profile, see app_config.h */
+#include "app_config.h"
+
 /* Get the low power configuration parameters from
  * the ModusToolbox Device Configurator GeneratedSource:
  * CY_CFG_PWR_SYS_IDLE_MODE     - System Idle Power Mode
@@ -95,7 +98,7 @@
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
 extern uint32_t SystemCoreClock;
 #define configCPU_CLOCK_HZ                      SystemCoreClock
-#define configTICK_RATE_HZ                      1000u
+#define configTICK_RATE_HZ                      APP_RTOS_TICK_RATE_HZ
 #define configMAX_PRIORITIES                    7
 #define configMINIMAL_STACK_SIZE                128
 #define configMAX_TASK_NAME_LEN                 16
@@ -114,11 +117,11 @@ extern uint32_t SystemCoreClock;
 /* Memory allocation related definitions. */
 #define configSUPPORT_STATIC_ALLOCATION         1
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   10240
+#define configTOTAL_HEAP_SIZE                   APP_RTOS_HEAP_SIZE
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
-#define configUSE_IDLE_HOOK                     0
+#define configUSE_IDLE_HOOK                     1
 #define configUSE_TICK_HOOK                     0
 #define configCHECK_FOR_STACK_OVERFLOW          2
 #define configUSE_MALLOC_FAILED_HOOK            1
@@ -241,7 +244,7 @@ standard names - or at least those used in the unmodified vector table. */
 #define HEAP_ALLOCATION_TYPE5                   (5)     /* heap_5.c*/
 #define NO_HEAP_ALLOCATION                      (0)
 
-#define configHEAP_ALLOCATION_SCHEME            (HEAP_ALLOCATION_TYPE3)
+#define configHEAP_ALLOCATION_SCHEME            (APP_RTOS_HEAP_SCHEME)
 
 /* Check if the ModusToolbox Device Configurator Power personality parameter
  * "System Idle Power Mode" is set to either "CPU Sleep" or "System Deep Sleep".
@@ -284,4 +287,11 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
  */
 #define configUSE_NEWLIB_REENTRANT              1
 
+/* Record heap allocations in the USB call trace, see usb_trace.h */
+#if defined(USB_TRACE_ENABLE) && (USB_TRACE_ENABLE)
+#include "usb_trace.h"
+#define traceMALLOC( pvAddress, uiSize )        USB_TRACE( USB_TRACE_EVT_ALLOC, 0U, ( uiSize ), NULL, 0U )
+#define traceFREE( pvAddress, uiSize )          USB_TRACE( USB_TRACE_EVT_FREE, 0U, ( uiSize ), NULL, 0U )
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
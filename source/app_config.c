@@ -0,0 +1,158 @@
+/*********************************************************************************
+* File Name        :   app_config.c
+*
+* Description      :   Consistency checks and build time report of the selected
+*                      build profile, see app_config.h
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+
+#include "app_config.h"
+#include "app_metrics.h"
+#include "cdc_mux_format.h"
+#include "cdc_serial_state.h"
+
+#define APP_CONFIG_STR_(x)              #x
+#define APP_CONFIG_STR(x)               APP_CONFIG_STR_(x)
+
+/*********************************************************************
+*
+*      Consistency checks
+*
+**********************************************************************/
+_Static_assert((APP_CDC_RX_BUFFER_SIZE >= 64U) && ((APP_CDC_RX_BUFFER_SIZE % 64U) == 0U),
+               "APP_CDC_RX_BUFFER_SIZE must be a non-zero multiple of the bulk packet size");
+_Static_assert((APP_CDC_OUT_BUFFER_PACKETS >= 1U) && (APP_CDC_OUT_BUFFER_PACKETS <= 16U),
+               "APP_CDC_OUT_BUFFER_PACKETS must be between 1 and 16");
+_Static_assert((APP_INT_EP_INTERVAL >= 8U) && (APP_INT_EP_INTERVAL <= 255U),
+               "APP_INT_EP_INTERVAL must be 1 ms (8) or more for full-speed and fit into 8 bits");
+_Static_assert((APP_CDC_TX_STALL_TIMEOUT * 8U) >= APP_INT_EP_INTERVAL,
+               "DSR changes shorter than one interrupt endpoint interval would not reach the host");
+_Static_assert((APP_DELAY_TASK > 0U) && (APP_USB_CONFIG_DELAY > 0U) && (APP_CDC_TX_STALL_TIMEOUT > 0U),
+               "Polling periods must not be zero");
+
+_Static_assert((APP_PRIO_USBH_ISR_TASK < configMAX_PRIORITIES) && (APP_PRIO_MAIN_TASK > 0) &&
+               (APP_PRIO_USBH_TASK > 0) && (APP_PRIO_LOG_TASK > 0),
+               "Task priorities must be between 1 and configMAX_PRIORITIES - 1");
+_Static_assert(APP_PRIO_USBH_ISR_TASK > APP_PRIO_USBH_TASK,
+               "usbh_isr_task must have a higher priority than usbh_task");
+_Static_assert(APP_PRIO_MAIN_TASK < APP_PRIO_USBH_TASK,
+               "Tasks using emUSB-Host must have a lower priority than the emUSB-Host tasks");
+_Static_assert((APP_PRIO_LOG_TASK > 0) && (APP_PRIO_LOG_TASK < APP_PRIO_MAIN_TASK),
+               "log_task must run below the application and above the idle task");
+
+_Static_assert((APP_MAIN_TASK_STACK_SIZE >= configMINIMAL_STACK_SIZE) &&
+               (APP_USBH_TASK_STACK_SIZE >= configMINIMAL_STACK_SIZE) &&
+               (APP_USBH_ISR_TASK_STACK_SIZE >= configMINIMAL_STACK_SIZE) &&
+               (APP_LOG_TASK_STACK_SIZE >= configMINIMAL_STACK_SIZE),
+               "Task stacks must not be smaller than configMINIMAL_STACK_SIZE");
+
+_Static_assert((APP_LOG_LEVEL >= APP_LOG_LEVEL_NONE) && (APP_LOG_LEVEL <= APP_LOG_LEVEL_DATA),
+               "Invalid APP_LOG_LEVEL");
+_Static_assert((APP_LOG_QUEUE_LENGTH > 0U) && (APP_LOG_MSG_SIZE >= 32U),
+               "The log queue must hold at least one message of 32 bytes");
+_Static_assert((APP_LOG_LEVEL < APP_LOG_LEVEL_DATA) || (APP_CDC_RX_BUFFER_SIZE <= 64U),
+               "Per-packet data logging defeats large receive buffers, lower APP_LOG_LEVEL");
+
+_Static_assert((APP_CDC_RTO_MIN_MS > 0U) && (APP_CDC_RTO_MIN_MS <= APP_CDC_RTO_INITIAL_MS) &&
+               (APP_CDC_RTO_INITIAL_MS <= APP_CDC_RTO_MAX_MS),
+               "CDC timeouts must satisfy 0 < APP_CDC_RTO_MIN_MS <= APP_CDC_RTO_INITIAL_MS <= APP_CDC_RTO_MAX_MS");
+_Static_assert((APP_CDC_RETRY_BACKOFF_MS <= APP_CDC_RETRY_BACKOFF_MAX_MS) && (APP_CDC_MAX_RETRIES <= 8U),
+               "Invalid CDC retry backoff");
+_Static_assert((APP_CDC_MAX_DEVICES > 0U) && (APP_CDC_MAX_DEVICES <= 127U),
+               "APP_CDC_MAX_DEVICES must be between 1 and 127");
+
+#if (APP_CDC_MUX_ENABLE)
+_Static_assert(APP_OTG_SWAP_INTERVAL_MS == 0U,
+               "The OTG role swap test needs the echo test, the CDC multiplexer holds the devices open");
+_Static_assert(((APP_CDC_MUX_READ_SIZE % 64U) == 0U) && (APP_CDC_MUX_READ_SIZE <= 0xFFFFU),
+               "APP_CDC_MUX_READ_SIZE must be a multiple of the packet size");
+_Static_assert(APP_CDC_MUX_BATCH_SIZE >= (sizeof(CDC_MUX_HEADER) + sizeof(CDC_MUX_RECORD) + APP_CDC_MUX_READ_SIZE),
+               "APP_CDC_MUX_BATCH_SIZE must hold at least one full read");
+_Static_assert((APP_CDC_MUX_RING_SIZE & (APP_CDC_MUX_RING_SIZE - 1U)) == 0U,
+               "APP_CDC_MUX_RING_SIZE must be a power of two");
+_Static_assert((APP_CDC_MUX_READER_STACK_SIZE * 4U) >= ((configMINIMAL_STACK_SIZE * 4U) + APP_CDC_MUX_READ_SIZE),
+               "The reader stack must hold the read buffer");
+_Static_assert((APP_PRIO_CDC_MUX_READER < APP_PRIO_USBH_TASK) && (APP_PRIO_CDC_MUX_FLUSH <= APP_PRIO_CDC_MUX_READER),
+               "The multiplexer tasks must not preempt emUSB-Host");
+#endif
+
+_Static_assert(APP_OTG_STRESS_REPORT_INTERVAL > 0U, "APP_OTG_STRESS_REPORT_INTERVAL must not be 0");
+_Static_assert((APP_OTG_SWAP_TIMEOUT_MS > 0U) && (APP_OTG_SRP_TIMEOUT_MS > 0U),
+               "Role swap and session request timeouts must not be zero");
+_Static_assert((APP_OTG_HNP_ENABLE_RATE != 0U) && (APP_OTG_HNP_ENABLE_RATE != 115200U),
+               "APP_OTG_HNP_ENABLE_RATE must differ from the baud rate of the echo");
+
+_Static_assert(sizeof(StaticTask_t) <= APP_TCB_SIZE_MAX,
+               "APP_TCB_SIZE_MAX is smaller than StaticTask_t");
+_Static_assert(APP_USB_POOL_SIZE >= APP_USB_POOL_HOST_RAM,
+               "APP_USB_POOL_SIZE is too small for the emUSB-Host tasks");
+_Static_assert(APP_USB_POOL_SIZE >= APP_USB_POOL_DEVICE_RAM,
+               "APP_USB_POOL_SIZE is too small for the device endpoint buffers");
+
+_Static_assert(CDC_SERIAL_STATE_FIRST_WAIT_MS >= (APP_DELAY_TASK + CDC_SERIAL_STATE_INTERVAL_MS),
+               "CDC_SERIAL_STATE_FIRST_WAIT_MS must cover a blocked device loop and one interrupt interval");
+
+_Static_assert((1000U % APP_RTOS_TICK_RATE_HZ) == 0U,
+               "APP_RTOS_TICK_RATE_HZ must divide 1000 so pdMS_TO_TICKS() is exact");
+
+#if (APP_RTOS_HEAP_SCHEME != HEAP_ALLOCATION_TYPE3)
+/* heap_3 uses the C library heap. All other schemes must fit every dynamically
+ * created task into configTOTAL_HEAP_SIZE, including the idle and timer service
+ * task. The emUSB-Host tasks live in the USB session pool. */
+_Static_assert((APP_TASK_STACK_RAM + ((configMINIMAL_STACK_SIZE + configTIMER_TASK_STACK_DEPTH) * 4U) +
+                (4U * APP_TCB_SIZE_MAX)) <= APP_RTOS_HEAP_SIZE,
+               "APP_RTOS_HEAP_SIZE is too small for the task stacks of this profile");
+#endif
+
+/*********************************************************************
+*
+*      Build time report
+*
+*  The linked RAM/flash footprint is printed by the POSTBUILD step of
+*  the Makefile.
+*
+**********************************************************************/
+#pragma message("Build profile: " APP_PROFILE_NAME)
+#pragma message("  CDC receive buffer: " APP_CONFIG_STR(APP_CDC_RX_BUFFER_SIZE) " bytes, OUT EP buffer: " APP_CONFIG_STR(APP_CDC_OUT_BUFFER_PACKETS) " packets")
+#pragma message("  Task stacks (words): main " APP_CONFIG_STR(APP_MAIN_TASK_STACK_SIZE) ", usbh " APP_CONFIG_STR(APP_USBH_TASK_STACK_SIZE) ", usbh_isr " APP_CONFIG_STR(APP_USBH_ISR_TASK_STACK_SIZE))
+#pragma message("  RTOS heap: scheme " APP_CONFIG_STR(APP_RTOS_HEAP_SCHEME) ", " APP_CONFIG_STR(APP_RTOS_HEAP_SIZE) " bytes")
+#pragma message("  Log level: " APP_CONFIG_STR(APP_LOG_LEVEL))
+#pragma message("  CDC stream stage: " APP_CONFIG_STR(APP_CDC_STREAM))
+#pragma message("  CDC host multiplexer: " APP_CONFIG_STR(APP_CDC_MUX_ENABLE) ", sink " APP_CONFIG_STR(APP_CDC_MUX_SINK))
+#pragma message("  Metrics registry: " APP_CONFIG_STR(APP_METRICS_ENABLE))
@@ -0,0 +1,416 @@
+/*********************************************************************************
+* File Name        :   app_config.h
+*
+* Description      :   Compile-time build profiles. Selects a named profile and
+*                      derives all tuning parameters of the application, emUSB
+*                      and FreeRTOS from it.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/*
+ * This header is included by FreeRTOSConfig.h, so it must only contain
+ * preprocessor definitions. Consistency checks live in app_config.c.
+ *
+ * Select the profile with "make build APP_PROFILE=<name>", where <name> is
+ * one of DEFAULT, MAX_THROUGHPUT, LOW_LATENCY or MIN_RAM.
+ */
+
+/*********************************************************************
+*
+*      Profiles
+*
+**********************************************************************/
+#define APP_PROFILE_DEFAULT             (0)     /* Settings of the original code example */
+#define APP_PROFILE_MAX_THROUGHPUT      (1)     /* Large buffers, no per-packet logging */
+#define APP_PROFILE_LOW_LATENCY         (2)     /* Short polling intervals, small transfers */
+#define APP_PROFILE_MIN_RAM             (3)     /* Smallest buffers and stacks, errors only */
+
+#ifndef APP_PROFILE
+#define APP_PROFILE                     APP_PROFILE_DEFAULT
+#endif
+
+/* Log levels, see app_log.h */
+#define APP_LOG_LEVEL_NONE              (0)
+#define APP_LOG_LEVEL_ERROR             (1)
+#define APP_LOG_LEVEL_INFO              (2)
+#define APP_LOG_LEVEL_DATA              (3)     /* Additionally logs every data packet */
+
+/*
+ * Per profile parameters:
+ *
+ * APP_CDC_RX_BUFFER_SIZE       Bytes requested per USBD_CDC_Receive() call
+ * APP_CDC_OUT_BUFFER_PACKETS   Bulk OUT endpoint buffer, in max. size packets
+ * APP_INT_EP_INTERVAL          Interrupt IN endpoint interval, in 125 us units
+ * APP_DELAY_TASK               Host application polling period in ms
+ * APP_USB_CONFIG_DELAY         OTG detection and enumeration polling period in ms
+ * APP_CDC_TX_STALL_TIMEOUT     Device write time in ms after which DSR is dropped
+ * APP_MAIN_TASK_STACK_SIZE     Stack of main_task in words
+ * APP_USBH_TASK_STACK_SIZE     Stack of usbh_task in words
+ * APP_USBH_ISR_TASK_STACK_SIZE Stack of usbh_isr_task in words
+ * APP_LOG_TASK_STACK_SIZE      Stack of log_task in words
+ * APP_LOG_LEVEL                One of APP_LOG_LEVEL_*
+ * APP_LOG_QUEUE_LENGTH         Number of log messages buffered for log_task
+ * APP_LOG_MSG_SIZE             Maximum length of one log message
+ * APP_RTOS_HEAP_SCHEME         FreeRTOS heap implementation
+ * APP_RTOS_HEAP_SIZE           FreeRTOS heap size in bytes (heap_1/2/4 only)
+ * APP_RTOS_TICK_RATE_HZ        FreeRTOS tick rate
+ */
+#if (APP_PROFILE == APP_PROFILE_DEFAULT)
+
+#define APP_PROFILE_NAME                "default"
+#define APP_CDC_RX_BUFFER_SIZE          (64U)
+#define APP_CDC_OUT_BUFFER_PACKETS      (1U)
+#define APP_INT_EP_INTERVAL             (64U)
+#define APP_DELAY_TASK                  (100U)
+#define APP_USB_CONFIG_DELAY            (50U)
+#define APP_CDC_TX_STALL_TIMEOUT        (50U)
+#define APP_MAIN_TASK_STACK_SIZE        (512U)
+#define APP_USBH_TASK_STACK_SIZE        (500U)
+#define APP_USBH_ISR_TASK_STACK_SIZE    (500U)
+#define APP_LOG_TASK_STACK_SIZE         (320U)
+#define APP_LOG_LEVEL                   APP_LOG_LEVEL_DATA
+#define APP_LOG_QUEUE_LENGTH            (16U)
+#define APP_LOG_MSG_SIZE                (96U)
+#define APP_RTOS_HEAP_SCHEME            HEAP_ALLOCATION_TYPE3
+#define APP_RTOS_HEAP_SIZE              (10240U)
+#define APP_RTOS_TICK_RATE_HZ           (1000U)
+
+#elif (APP_PROFILE == APP_PROFILE_MAX_THROUGHPUT)
+
+#define APP_PROFILE_NAME                "max-throughput"
+#define APP_CDC_RX_BUFFER_SIZE          (512U)
+#define APP_CDC_OUT_BUFFER_PACKETS      (8U)
+#define APP_INT_EP_INTERVAL             (64U)
+#define APP_DELAY_TASK                  (100U)
+#define APP_USB_CONFIG_DELAY            (50U)
+#define APP_CDC_TX_STALL_TIMEOUT        (50U)
+#define APP_MAIN_TASK_STACK_SIZE        (512U)
+#define APP_USBH_TASK_STACK_SIZE        (500U)
+#define APP_USBH_ISR_TASK_STACK_SIZE    (500U)
+#define APP_LOG_TASK_STACK_SIZE         (320U)
+#define APP_LOG_LEVEL                   APP_LOG_LEVEL_INFO
+#define APP_LOG_QUEUE_LENGTH            (16U)
+#define APP_LOG_MSG_SIZE                (96U)
+#define APP_RTOS_HEAP_SCHEME            HEAP_ALLOCATION_TYPE3
+#define APP_RTOS_HEAP_SIZE              (10240U)
+#define APP_RTOS_TICK_RATE_HZ           (1000U)
+
+#elif (APP_PROFILE == APP_PROFILE_LOW_LATENCY)
+
+#define APP_PROFILE_NAME                "low-latency"
+#define APP_CDC_RX_BUFFER_SIZE          (64U)
+#define APP_CDC_OUT_BUFFER_PACKETS      (2U)
+#define APP_INT_EP_INTERVAL             (8U)
+#define APP_DELAY_TASK                  (10U)
+#define APP_USB_CONFIG_DELAY            (10U)
+#define APP_CDC_TX_STALL_TIMEOUT        (5U)
+#define APP_MAIN_TASK_STACK_SIZE        (512U)
+#define APP_USBH_TASK_STACK_SIZE        (500U)
+#define APP_USBH_ISR_TASK_STACK_SIZE    (500U)
+#define APP_LOG_TASK_STACK_SIZE         (320U)
+#define APP_LOG_LEVEL                   APP_LOG_LEVEL_INFO
+#define APP_LOG_QUEUE_LENGTH            (16U)
+#define APP_LOG_MSG_SIZE                (96U)
+#define APP_RTOS_HEAP_SCHEME            HEAP_ALLOCATION_TYPE4
+#define APP_RTOS_HEAP_SIZE              (12288U)
+#define APP_RTOS_TICK_RATE_HZ           (1000U)
+
+#elif (APP_PROFILE == APP_PROFILE_MIN_RAM)
+
+#define APP_PROFILE_NAME                "min-ram"
+#define APP_CDC_RX_BUFFER_SIZE          (64U)
+#define APP_CDC_OUT_BUFFER_PACKETS      (1U)
+#define APP_INT_EP_INTERVAL             (255U)
+#define APP_DELAY_TASK                  (100U)
+#define APP_USB_CONFIG_DELAY            (50U)
+#define APP_CDC_TX_STALL_TIMEOUT        (50U)
+#define APP_MAIN_TASK_STACK_SIZE        (384U)
+#define APP_USBH_TASK_STACK_SIZE        (384U)
+#define APP_USBH_ISR_TASK_STACK_SIZE    (256U)
+#define APP_LOG_TASK_STACK_SIZE         (256U)
+#define APP_LOG_LEVEL                   APP_LOG_LEVEL_ERROR
+#define APP_LOG_QUEUE_LENGTH            (4U)
+#define APP_LOG_MSG_SIZE                (64U)
+#define APP_RTOS_HEAP_SCHEME            HEAP_ALLOCATION_TYPE4
+#define APP_RTOS_HEAP_SIZE              (8192U)
+#define APP_RTOS_TICK_RATE_HZ           (1000U)
+
+#else
+#error "Unknown APP_PROFILE, use DEFAULT, MAX_THROUGHPUT, LOW_LATENCY or MIN_RAM"
+#endif
+
+/*********************************************************************
+*
+*      Task priority scheme
+*
+*  From highest to lowest:
+*  - usbh_isr_task  Deferred USB interrupt handling of emUSB-Host
+*  - usbh_task      emUSB-Host timers and housekeeping
+*  - main_task      OTG session control and application data (echo)
+*  - timer service  FreeRTOS software timers (configTIMER_TASK_PRIORITY)
+*  - log_task       Prints the queued log messages on the debug UART
+*
+*  emUSB-Host requires its tasks to run above every task using its API.
+*  The values can be overridden through DEFINES in the Makefile; the
+*  ordering is checked in app_config.c.
+*
+**********************************************************************/
+#ifndef APP_PRIO_USBH_ISR_TASK
+#define APP_PRIO_USBH_ISR_TASK          (configMAX_PRIORITIES - 1)
+#endif
+
+#ifndef APP_PRIO_USBH_TASK
+#define APP_PRIO_USBH_TASK              (configMAX_PRIORITIES - 2)
+#endif
+
+#ifndef APP_PRIO_MAIN_TASK
+#define APP_PRIO_MAIN_TASK              (configMAX_PRIORITIES - 3)
+#endif
+
+#ifndef APP_PRIO_LOG_TASK
+#define APP_PRIO_LOG_TASK               (1)
+#endif
+
+/*********************************************************************
+*
+*      USB device suspend handling, see usb_suspend.c
+*
+**********************************************************************/
+#ifndef APP_USB_SUSPEND_TIMEOUT_MS
+#define APP_USB_SUSPEND_TIMEOUT_MS      (60000U)    /* Suspend longer than this ends the session */
+#endif
+
+/*********************************************************************
+*
+*      CDC stream processing stage, see cdc_stream.c
+*
+*  Select the stage with "make build CDC_STREAM=<name>", where <name> is
+*  one of NONE, BSWAP32, CHECKSUM, SLIP or COBS. The device applies the
+*  encoder to the received data before the echo, the host applies the
+*  decoder to the echo it reads back.
+*
+**********************************************************************/
+#define APP_CDC_STREAM_NONE             (0)     /* Echo data unchanged */
+#define APP_CDC_STREAM_BSWAP32          (1)     /* Swap the byte order of 32-bit words */
+#define APP_CDC_STREAM_CHECKSUM         (2)     /* Append a 16-bit byte sum */
+#define APP_CDC_STREAM_SLIP             (3)     /* SLIP framing, RFC 1055 */
+#define APP_CDC_STREAM_COBS             (4)     /* Consistent overhead byte stuffing */
+
+#ifndef APP_CDC_STREAM
+#define APP_CDC_STREAM                  APP_CDC_STREAM_NONE
+#endif
+
+/* Capacity of a buffer for n bytes after processing. SLIP has the largest
+ * worst case of all stages: every byte escaped, plus the END character. The
+ * size does not depend on APP_CDC_STREAM, cdc_stream_set_stage() can install
+ * any stage at runtime. */
+#define APP_CDC_STREAM_BUFFER_SIZE(n)   ((2U * (n)) + 2U)
+
+/*********************************************************************
+*
+*      OTG session stress test, see otg_session.c
+*
+**********************************************************************/
+#ifndef APP_OTG_STRESS_CYCLES
+#define APP_OTG_STRESS_CYCLES           (0U)        /* Attach/detach cycles, 0 disables the test */
+#endif
+#ifndef APP_OTG_STRESS_HOLD_MS
+#define APP_OTG_STRESS_HOLD_MS          (100U)      /* Time a stress session stays enumerated */
+#endif
+#ifndef APP_OTG_STRESS_REPORT_INTERVAL
+#define APP_OTG_STRESS_REPORT_INTERVAL  (100U)      /* Cycles between two stress reports */
+#endif
+
+/*********************************************************************
+*
+*      OTG role swap and session request, see otg_role.c
+*
+**********************************************************************/
+#ifndef APP_OTG_SWAP_INTERVAL_MS
+#define APP_OTG_SWAP_INTERVAL_MS        (0U)        /* Swap roles after a session was ready this long, 0 disables */
+#endif
+#ifndef APP_OTG_SWAP_TIMEOUT_MS
+#define APP_OTG_SWAP_TIMEOUT_MS         (3000U)     /* A swapped role not ready by then falls back to the ID pin */
+#endif
+#ifndef APP_OTG_HNP_ENABLE_RATE
+/* SetLineCoding rate that carries the HNP enable, "HNP". Any host application
+ * that sets this baud rate starts a role swap of the device. */
+#define APP_OTG_HNP_ENABLE_RATE         (0x00484E50UL)
+#endif
+#ifndef APP_OTG_SRP_INTERVAL_MS
+#define APP_OTG_SRP_INTERVAL_MS         (0U)        /* B-device without VBUS requests a session this often, 0 disables */
+#endif
+#ifndef APP_OTG_SRP_TIMEOUT_MS
+#define APP_OTG_SRP_TIMEOUT_MS          (100U)      /* Time the A-device has to turn on VBUS */
+#endif
+
+/*********************************************************************
+*
+*      CDC host timeout and retry policy, see cdc_host_rto.c
+*
+**********************************************************************/
+#ifndef APP_CDC_MAX_DEVICES
+#define APP_CDC_MAX_DEVICES             (4U)    /* CDC devices tracked by the host */
+#endif
+
+#ifndef APP_CDC_RTO_INITIAL_MS
+#define APP_CDC_RTO_INITIAL_MS          (50U)   /* Timeout before the first round trip was measured */
+#endif
+
+#ifndef APP_CDC_RTO_MIN_MS
+#define APP_CDC_RTO_MIN_MS              (5U)
+#endif
+
+#ifndef APP_CDC_RTO_MAX_MS
+#define APP_CDC_RTO_MAX_MS              (2000U)
+#endif
+
+#ifndef APP_CDC_MAX_RETRIES
+#define APP_CDC_MAX_RETRIES             (3U)    /* Retries after the first timed out attempt */
+#endif
+
+#ifndef APP_CDC_RETRY_BACKOFF_MS
+#define APP_CDC_RETRY_BACKOFF_MS        (10U)   /* Delay before the first retry, doubled per retry */
+#endif
+
+#ifndef APP_CDC_RETRY_BACKOFF_MAX_MS
+#define APP_CDC_RETRY_BACKOFF_MAX_MS    (200U)
+#endif
+
+/*********************************************************************
+*
+*      CDC host fan-in multiplexer, see cdc_mux.c
+*
+*  Enable with "make build CDC_MUX=1". The host then reads all attached
+*  CDC devices continuously instead of running the echo test, and writes
+*  the data as framed batches to the sink selected with CDC_MUX_SINK.
+*
+**********************************************************************/
+#define APP_CDC_MUX_SINK_RAM            (0)     /* Ring buffer, read with cdc_mux_ring_read() */
+#define APP_CDC_MUX_SINK_UART           (1)     /* Debug UART, shared with the log */
+
+#ifndef APP_CDC_MUX_ENABLE
+#define APP_CDC_MUX_ENABLE              (0)
+#endif
+
+#ifndef APP_CDC_MUX_SINK
+#define APP_CDC_MUX_SINK                APP_CDC_MUX_SINK_RAM
+#endif
+
+#ifndef APP_CDC_MUX_READ_SIZE
+#define APP_CDC_MUX_READ_SIZE           (256U)  /* Bytes per read, multiple of 64 */
+#endif
+
+#ifndef APP_CDC_MUX_READ_TIMEOUT_MS
+#define APP_CDC_MUX_READ_TIMEOUT_MS     (20U)   /* Bounds the reaction time to a shutdown */
+#endif
+
+#ifndef APP_CDC_MUX_RETRY_MS
+#define APP_CDC_MUX_RETRY_MS            (500U)  /* Delay before an attached device is opened again after an error */
+#endif
+
+#ifndef APP_CDC_MUX_BATCH_SIZE
+#define APP_CDC_MUX_BATCH_SIZE          (1024U) /* Largest batch, header and records */
+#endif
+
+#ifndef APP_CDC_MUX_FLUSH_MS
+#define APP_CDC_MUX_FLUSH_MS            (10U)   /* A partially filled batch is sent after this time */
+#endif
+
+#ifndef APP_CDC_MUX_RING_SIZE
+#define APP_CDC_MUX_RING_SIZE           (4096U)
+#endif
+
+#ifndef APP_CDC_MUX_READER_STACK_SIZE
+#define APP_CDC_MUX_READER_STACK_SIZE   (384U)  /* In words, one reader task per device */
+#endif
+
+#ifndef APP_CDC_MUX_FLUSH_STACK_SIZE
+#define APP_CDC_MUX_FLUSH_STACK_SIZE    (384U)  /* In words */
+#endif
+
+#ifndef APP_PRIO_CDC_MUX_READER
+#define APP_PRIO_CDC_MUX_READER         (APP_PRIO_MAIN_TASK)
+#endif
+
+#ifndef APP_PRIO_CDC_MUX_FLUSH
+#define APP_PRIO_CDC_MUX_FLUSH          (APP_PRIO_LOG_TASK)
+#endif
+
+/* RAM statically reserved by the application for USB data buffers, in bytes */
+#define APP_USB_BUFFER_RAM              ((APP_CDC_RX_BUFFER_SIZE + 1U) + \
+                                         (APP_CDC_OUT_BUFFER_PACKETS * 64U) + 64U)
+
+/* RAM needed by the task stacks allocated from the FreeRTOS heap, in bytes */
+#define APP_TASK_STACK_RAM              ((APP_MAIN_TASK_STACK_SIZE + APP_LOG_TASK_STACK_SIZE) * 4U)
+
+/* Worst case size of a task control block (StaticTask_t), in bytes */
+#define APP_TCB_SIZE_MAX                (128U)
+
+/*********************************************************************
+*
+*      USB session pool, see usb_pool.c
+*
+*  Holds everything a host or device session allocates: the emUSB-Host
+*  and multiplexer task stacks and control blocks, and the bulk OUT
+*  endpoint buffer.
+*  Only one session is active at a time.
+*
+**********************************************************************/
+#if (APP_CDC_MUX_ENABLE)
+#define APP_CDC_MUX_POOL_RAM            ((((APP_CDC_MAX_DEVICES * APP_CDC_MUX_READER_STACK_SIZE) + \
+                                           APP_CDC_MUX_FLUSH_STACK_SIZE) * 4U) + \
+                                         ((APP_CDC_MAX_DEVICES + 1U) * APP_TCB_SIZE_MAX))
+#else
+#define APP_CDC_MUX_POOL_RAM            (0U)
+#endif
+
+#define APP_USB_POOL_HOST_RAM           (((APP_USBH_TASK_STACK_SIZE + APP_USBH_ISR_TASK_STACK_SIZE) * 4U) + \
+                                         (2U * APP_TCB_SIZE_MAX) + APP_CDC_MUX_POOL_RAM)
+#define APP_USB_POOL_DEVICE_RAM         (APP_CDC_OUT_BUFFER_PACKETS * 64U)
+
+#ifndef APP_USB_POOL_SIZE
+#define APP_USB_POOL_SIZE               (((APP_USB_POOL_HOST_RAM > APP_USB_POOL_DEVICE_RAM) ? \
+                                          APP_USB_POOL_HOST_RAM : APP_USB_POOL_DEVICE_RAM) + 256U)
+#endif
+#ifndef APP_USB_POOL_STOP_TIMEOUT_MS
+#define APP_USB_POOL_STOP_TIMEOUT_MS    (1000U)     /* Time the emUSB-Host tasks have to exit before the pool is kept */
+#endif
+
+#endif /* APP_CONFIG_H */
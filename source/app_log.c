@@ -0,0 +1,244 @@
+/*********************************************************************************
+* File Name        :   app_log.c
+*
+* Description      :   Deferred application logging. Messages are queued by the
+*                      calling task and printed by log_task at APP_PRIO_LOG_TASK.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "app_log.h"
+#include "app_metrics.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static QueueHandle_t     log_queue;
+static StaticQueue_t     log_queue_buffer;
+static uint8_t           log_queue_storage[APP_LOG_QUEUE_LENGTH * APP_LOG_MSG_SIZE];
+static volatile uint32_t log_dropped;
+
+/* Serializes log_task with other writers to the debug UART */
+static SemaphoreHandle_t log_uart_mutex;
+static StaticSemaphore_t log_uart_mutex_buffer;
+
+/***********************************************************************************
+ *  Function Name: log_task
+ ***********************************************************************************
+ * Summary:
+ * Prints the queued log messages on the debug UART.
+ *
+ * Parameters:
+ * arg - is not used in this function, is required by FreeRTOS
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void log_task(void* arg)
+{
+    char message[APP_LOG_MSG_SIZE];
+    uint32_t reported_drops = 0U;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (xQueueReceive(log_queue, message, portMAX_DELAY) == pdTRUE)
+        {
+            app_log_lock();
+            printf("%s\r\n", message);
+
+            if (log_dropped != reported_drops)
+            {
+                reported_drops = log_dropped;
+                printf("[log] %lu messages dropped\r\n", (unsigned long)reported_drops);
+            }
+            app_log_unlock();
+        }
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_log_init
+ ***********************************************************************************
+ * Summary:
+ * Creates the log queue and log_task. Messages logged before this call are
+ * printed directly.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void app_log_init(void)
+{
+    BaseType_t rtos_task_status;
+
+    if (log_queue != NULL)
+    {
+        return;
+    }
+
+    log_queue = xQueueCreateStatic(APP_LOG_QUEUE_LENGTH, APP_LOG_MSG_SIZE,
+                                   log_queue_storage, &log_queue_buffer);
+    log_uart_mutex = xSemaphoreCreateMutexStatic(&log_uart_mutex_buffer);
+
+    rtos_task_status = xTaskCreate(log_task, "log_task", APP_LOG_TASK_STACK_SIZE, NULL,
+                                   APP_PRIO_LOG_TASK, NULL);
+    if (rtos_task_status != pdPASS)
+    {
+        CY_ASSERT(0);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_log_printf
+ ***********************************************************************************
+ * Summary:
+ * Formats a log message and queues it for log_task. Messages longer than
+ * APP_LOG_MSG_SIZE are truncated. If the queue is full, the message is dropped
+ * and counted instead of blocking the caller. Must be called from a task.
+ *
+ * Parameters:
+ * format - printf style format string
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void app_log_printf(const char* format, ...)
+{
+    char    message[APP_LOG_MSG_SIZE];
+    va_list args;
+    int     length;
+
+    va_start(args, format);
+    length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        return;
+    }
+
+    if (log_queue == NULL)
+    {
+        printf("%s\r\n", message);
+    }
+    else if (xQueueSend(log_queue, message, 0U) != pdTRUE)
+    {
+        log_dropped++;
+        app_metrics_inc(APP_METRIC_LOG_DROPPED);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_log_lock
+ ***********************************************************************************
+ * Summary:
+ * Takes exclusive access to the debug UART, so output that is not a log message
+ * (for example the USB trace dump) is not interleaved with log messages. Blocks
+ * while log_task prints a message. Must be called from a task.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void app_log_lock(void)
+{
+    if (log_uart_mutex != NULL)
+    {
+        (void)xSemaphoreTake(log_uart_mutex, portMAX_DELAY);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_log_unlock
+ ***********************************************************************************
+ * Summary:
+ * Releases the debug UART taken with app_log_lock().
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void app_log_unlock(void)
+{
+    if (log_uart_mutex != NULL)
+    {
+        (void)xSemaphoreGive(log_uart_mutex);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_log_get_dropped
+ ***********************************************************************************
+ * Summary:
+ * Returns the number of messages dropped because the log queue was full.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * uint32_t - number of dropped messages
+ *
+ **********************************************************************************/
+uint32_t app_log_get_dropped(void)
+{
+    return log_dropped;
+}
@@ -0,0 +1,81 @@
+/*********************************************************************************
+* File Name        :   app_log.h
+*
+* Description      :   Application log macros filtered by APP_LOG_LEVEL. The
+*                      messages are formatted by the caller and printed by a
+*                      low priority log task, so logging does not block the
+*                      USB data path on the debug UART.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void     app_log_init(void);
+void     app_log_printf(const char* format, ...);
+void     app_log_lock(void);
+void     app_log_unlock(void);
+uint32_t app_log_get_dropped(void);
+
+/* Disabled levels keep the call in dead code, so the arguments are still
+ * type checked and do not trigger unused variable warnings */
+#if (APP_LOG_LEVEL >= APP_LOG_LEVEL_ERROR)
+#define APP_LOG_ERROR(...)      app_log_printf(__VA_ARGS__)
+#else
+#define APP_LOG_ERROR(...)      do { if (0) { app_log_printf(__VA_ARGS__); } } while (0)
+#endif
+
+#if (APP_LOG_LEVEL >= APP_LOG_LEVEL_INFO)
+#define APP_LOG_INFO(...)       app_log_printf(__VA_ARGS__)
+#else
+#define APP_LOG_INFO(...)       do { if (0) { app_log_printf(__VA_ARGS__); } } while (0)
+#endif
+
+/* Per-packet logging, only enabled at APP_LOG_LEVEL_DATA */
+#if (APP_LOG_LEVEL >= APP_LOG_LEVEL_DATA)
+#define APP_LOG_DATA(...)       app_log_printf(__VA_ARGS__)
+#else
+#define APP_LOG_DATA(...)       do { if (0) { app_log_printf(__VA_ARGS__); } } while (0)
+#endif
+
+#endif /* APP_LOG_H */
@@ -0,0 +1,232 @@
+/*********************************************************************************
+* File Name        :   app_metrics.c
+*
+* Description      :   Lock-free metrics registry and the EP0 query protocol that reads
+*                      snapshots of it.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "app_metrics.h"
+
+#if (APP_METRICS_ENABLE)
+
+/* emUSB-Device header file includes */
+#include "USB.h"
+#include "USB_Bulk.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Largest snapshot: the header and all values */
+#define APP_METRICS_SNAPSHOT_SIZE   (sizeof(APP_METRICS_HEADER) + (APP_METRIC_COUNT * sizeof(uint32_t)))
+
+_Static_assert(APP_METRIC_COUNT <= 255U, "The snapshot header counts metrics in 8 bits");
+_Static_assert(sizeof(APP_METRICS_HEADER) == 12U, "Snapshot header layout differs from the query protocol");
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+volatile uint32_t app_metrics_values[APP_METRIC_COUNT];
+
+static uint16_t metrics_sequence;
+
+/* Response of the last request, emUSB-Device sends it after the callback returned */
+static uint32_t metrics_response[APP_METRICS_SNAPSHOT_SIZE / sizeof(uint32_t)];
+
+/* The metrics interface needs endpoints to be a valid interface, they are not
+ * used. The OUT endpoint takes a single packet. */
+static uint8_t  metrics_out_buffer[USB_FS_BULK_MAX_PACKET_SIZE];
+
+/***********************************************************************************
+ *  Function Name: app_metrics_get
+ ***********************************************************************************
+ * Summary:
+ * Returns the current value of a metric.
+ *
+ * Parameters:
+ * id - metric
+ *
+ * Return:
+ * uint32_t - value
+ *
+ **********************************************************************************/
+uint32_t app_metrics_get(app_metric_id_t id)
+{
+    return app_metrics_values[id];
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_snapshot
+ ***********************************************************************************
+ * Summary:
+ * Writes a snapshot in the layout of the query protocol: the header, followed
+ * by the values from metric first on, as many as fit. Safe in tasks and
+ * interrupts; no lock is taken.
+ *
+ * Parameters:
+ * data  - destination
+ * size  - capacity of data
+ * first - index of the first metric
+ *
+ * Return:
+ * uint32_t - number of bytes written, 0 if not even the header fits
+ *
+ **********************************************************************************/
+uint32_t app_metrics_snapshot(uint8_t* data, uint32_t size, uint32_t first)
+{
+    APP_METRICS_HEADER header;
+    uint32_t           count = 0U;
+
+    if (size < sizeof(header))
+    {
+        return 0U;
+    }
+
+    if (first < APP_METRIC_COUNT)
+    {
+        count = (size - sizeof(header)) / sizeof(uint32_t);
+        if (count > (APP_METRIC_COUNT - first))
+        {
+            count = APP_METRIC_COUNT - first;
+        }
+    }
+
+    header.magic     = APP_METRICS_MAGIC;
+    header.version   = APP_METRICS_VERSION;
+    header.total     = (uint8_t)APP_METRIC_COUNT;
+    header.first     = (uint8_t)((first < APP_METRIC_COUNT) ? first : APP_METRIC_COUNT);
+    header.count     = (uint8_t)count;
+    header.sequence  = metrics_sequence++;
+    header.uptime_ms = (uint32_t)xTaskGetTickCountFromISR() * portTICK_PERIOD_MS;
+
+    memcpy(data, &header, sizeof(header));
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        uint32_t value = app_metrics_values[first + i];
+
+        memcpy(&data[sizeof(header) + (i * sizeof(value))], &value, sizeof(value));
+    }
+
+    return sizeof(header) + (count * sizeof(uint32_t));
+}
+
+/***********************************************************************************
+ *  Function Name: metrics_on_setup
+ ***********************************************************************************
+ * Summary:
+ * Answers the snapshot request on EP0. Called by emUSB-Device from the USB
+ * interrupt for setup packets of APP_METRICS_INTERFACE.
+ *
+ * Parameters:
+ * pSetupPacket - received setup packet
+ *
+ * Return:
+ * int - 0 if the request was handled, otherwise it is stalled
+ *
+ **********************************************************************************/
+static int metrics_on_setup(const USB_SETUP_PACKET* pSetupPacket)
+{
+    uint32_t length;
+
+    if ((pSetupPacket->bmRequestType != APP_METRICS_REQUEST_TYPE) ||
+        (pSetupPacket->bRequest != APP_METRICS_REQ_SNAPSHOT))
+    {
+        return 1;
+    }
+
+    length = app_metrics_snapshot((uint8_t*)metrics_response,
+                                  (pSetupPacket->wLength < sizeof(metrics_response)) ?
+                                  pSetupPacket->wLength : sizeof(metrics_response),
+                                  pSetupPacket->wValue);
+    if (length == 0U)
+    {
+        return 1;
+    }
+
+    /* A response shorter than requested ends with a short or zero length packet */
+    USBD_WriteEP0FromISR(metrics_response, length, (length < pSetupPacket->wLength) ? 1 : 0);
+
+    return 0;
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_device_init
+ ***********************************************************************************
+ * Summary:
+ * Adds the vendor specific metrics interface and registers the query protocol
+ * with emUSB-Device. The device becomes a composite device, so the CDC function
+ * is described by an interface association. Must be called after the CDC class
+ * was added and before USBD_Start().
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void app_metrics_device_init(void)
+{
+    USB_BULK_INIT_DATA InitData;
+    USB_ADD_EP_INFO    EPBulkIn;
+    USB_ADD_EP_INFO    EPBulkOut;
+
+    USBD_EnableIAD();
+
+    EPBulkIn.Flags          = 0;                             /* Flags not used */
+    EPBulkIn.InDir          = USB_DIR_IN;                    /* IN direction (Device to Host) */
+    EPBulkIn.Interval       = 0;                             /* Interval not used for Bulk endpoints */
+    EPBulkIn.MaxPacketSize  = USB_FS_BULK_MAX_PACKET_SIZE;   /* Maximum packet size (64B for Bulk in full-speed) */
+    EPBulkIn.TransferType   = USB_TRANSFER_TYPE_BULK;        /* Endpoint type - Bulk */
+    InitData.EPIn  = USBD_AddEPEx(&EPBulkIn, NULL, 0);
+
+    EPBulkOut.Flags         = 0;                             /* Flags not used */
+    EPBulkOut.InDir         = USB_DIR_OUT;                   /* OUT direction (Host to Device) */
+    EPBulkOut.Interval      = 0;                             /* Interval not used for Bulk endpoints */
+    EPBulkOut.MaxPacketSize = USB_FS_BULK_MAX_PACKET_SIZE;   /* Maximum packet size (64B for Bulk in full-speed) */
+    EPBulkOut.TransferType  = USB_TRANSFER_TYPE_BULK;        /* Endpoint type - Bulk */
+    InitData.EPOut = USBD_AddEPEx(&EPBulkOut, metrics_out_buffer, sizeof(metrics_out_buffer));
+
+    (void)USBD_BULK_Add(&InitData);
+    USBD_SetOnSetupHook(APP_METRICS_INTERFACE, metrics_on_setup);
+}
+
+#endif /* APP_METRICS_ENABLE */
@@ -0,0 +1,193 @@
+/*********************************************************************************
+* File Name        :   app_metrics.h
+*
+* Description      :   Lock-free metrics registry. Counters and gauges can be updated
+*                      from tasks and interrupts without locks.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef APP_METRICS_H
+#define APP_METRICS_H
+
+#include <stdint.h>
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+#include "app_metrics_format.h"
+
+/***********************************************************************************
+ *  Define configurables
+ **********************************************************************************/
+/* Set METRICS=0 on the make command line to remove the registry */
+#ifndef APP_METRICS_ENABLE
+#define APP_METRICS_ENABLE          (1)
+#endif
+
+#if (APP_METRICS_ENABLE)
+
+extern volatile uint32_t app_metrics_values[APP_METRIC_COUNT];
+
+/***********************************************************************************
+ *  Function Name: app_metrics_add
+ ***********************************************************************************
+ * Summary:
+ * Adds to a counter or gauge. LDREX/STREX make the update atomic: an interrupt
+ * between the two clears the exclusive monitor, the store fails and the update
+ * is repeated. Safe in tasks and interrupts.
+ *
+ * Parameters:
+ * id    - metric
+ * value - amount to add
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_metrics_add(app_metric_id_t id, uint32_t value)
+{
+    volatile uint32_t* metric = &app_metrics_values[id];
+    uint32_t           updated;
+
+    do
+    {
+        updated = __LDREXW(metric) + value;
+    } while (__STREXW(updated, metric) != 0U);
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_sub
+ ***********************************************************************************
+ * Summary:
+ * Subtracts from a gauge, atomically like app_metrics_add().
+ *
+ * Parameters:
+ * id    - metric
+ * value - amount to subtract
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_metrics_sub(app_metric_id_t id, uint32_t value)
+{
+    app_metrics_add(id, 0U - value);
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_inc
+ ***********************************************************************************
+ * Summary:
+ * Increments a counter.
+ *
+ * Parameters:
+ * id - metric
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_metrics_inc(app_metric_id_t id)
+{
+    app_metrics_add(id, 1U);
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_set
+ ***********************************************************************************
+ * Summary:
+ * Sets a gauge. An aligned 32-bit store is atomic on the Cortex-M4.
+ *
+ * Parameters:
+ * id    - metric
+ * value - new value
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_metrics_set(app_metric_id_t id, uint32_t value)
+{
+    app_metrics_values[id] = value;
+}
+
+/***********************************************************************************
+ *  Function Name: app_metrics_max
+ ***********************************************************************************
+ * Summary:
+ * Raises a gauge to value if it is lower, atomically like app_metrics_add().
+ *
+ * Parameters:
+ * id    - metric
+ * value - candidate maximum
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_metrics_max(app_metric_id_t id, uint32_t value)
+{
+    volatile uint32_t* metric = &app_metrics_values[id];
+
+    do
+    {
+        if (__LDREXW(metric) >= value)
+        {
+            __CLREX();
+            return;
+        }
+    } while (__STREXW(value, metric) != 0U);
+}
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t app_metrics_get(app_metric_id_t id);
+uint32_t app_metrics_snapshot(uint8_t* data, uint32_t size, uint32_t first);
+void     app_metrics_device_init(void);
+
+#else
+
+#define app_metrics_add(id, value)      do { (void)(value); } while (0)
+#define app_metrics_sub(id, value)      do { (void)(value); } while (0)
+#define app_metrics_inc(id)             do { } while (0)
+#define app_metrics_set(id, value)      do { (void)(value); } while (0)
+#define app_metrics_max(id, value)      do { (void)(value); } while (0)
+#define app_metrics_device_init()       do { } while (0)
+
+#endif /* APP_METRICS_ENABLE */
+
+#endif /* APP_METRICS_H */
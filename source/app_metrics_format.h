@@ -0,0 +1,147 @@
+/*********************************************************************************
+* File Name        :   app_metrics_format.h
+*
+* Description      :   Metric definitions and snapshot layout of the metrics query
+*                      protocol. Shared between the firmware and the Linux decoder, so
+*                      this header must not depend on any target specific header.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef APP_METRICS_FORMAT_H
+#define APP_METRICS_FORMAT_H
+
+#include <stdint.h>
+
+/*********************************************************************
+*
+*      Metrics
+*
+*  X(id, type, module, name) for every metric, in snapshot order. New
+*  metrics are added at the end, so older decoders keep working.
+*  Counters only increase; gauges hold the current or last value.
+*
+**********************************************************************/
+#define APP_METRICS_LIST(X) \
+    X(DEVICE_ENUMERATIONS,      COUNTER,    "device",   "enumerations")         \
+    X(DEVICE_RX_PACKETS,        COUNTER,    "device",   "rx_packets")           \
+    X(DEVICE_RX_BYTES,          COUNTER,    "device",   "rx_bytes")             \
+    X(DEVICE_ECHO_BYTES,        COUNTER,    "device",   "echo_bytes")           \
+    X(DEVICE_TX_STALLS,         COUNTER,    "device",   "tx_stalls")            \
+    X(DEVICE_ECHO_DROPPED,      COUNTER,    "device",   "echo_dropped")         \
+    X(DEVICE_SUSPENDS,          COUNTER,    "device",   "suspends")             \
+    X(HOST_DEVICES_ADDED,       COUNTER,    "host",     "devices_added")        \
+    X(HOST_DEVICES_ATTACHED,    GAUGE,      "host",     "devices_attached")     \
+    X(HOST_TX_BYTES,            COUNTER,    "host",     "tx_bytes")             \
+    X(HOST_RX_BYTES,            COUNTER,    "host",     "rx_bytes")             \
+    X(HOST_TIMEOUTS,            COUNTER,    "host",     "timeouts")             \
+    X(HOST_RETRIES,             COUNTER,    "host",     "retries")              \
+    X(HOST_FAILURES,            COUNTER,    "host",     "failures")             \
+    X(HOST_ECHO_CORRUPT,        COUNTER,    "host",     "echo_corrupt")         \
+    X(MUX_BYTES,                COUNTER,    "mux",      "bytes")                \
+    X(MUX_DROPPED_BYTES,        COUNTER,    "mux",      "dropped_bytes")        \
+    X(MUX_FRAMES,               COUNTER,    "mux",      "frames")               \
+    X(MUX_FRAMES_DROPPED,       COUNTER,    "mux",      "frames_dropped")       \
+    X(OTG_STATE,                GAUGE,      "otg",      "state")                \
+    X(OTG_HOST_SESSIONS,        COUNTER,    "otg",      "host_sessions")        \
+    X(OTG_DEVICE_SESSIONS,      COUNTER,    "otg",      "device_sessions")      \
+    X(OTG_ROLE_SWAPS,           COUNTER,    "otg",      "role_swaps")           \
+    X(OTG_SWAP_FAILURES,        COUNTER,    "otg",      "swap_failures")        \
+    X(OTG_SWAP_LATENCY_MS,      GAUGE,      "otg",      "swap_latency_ms")      \
+    X(OTG_SESSION_REQUESTS,     COUNTER,    "otg",      "session_requests")     \
+    X(POOL_USED,                GAUGE,      "pool",     "used_bytes")           \
+    X(POOL_PEAK,                GAUGE,      "pool",     "peak_bytes")           \
+    X(LOG_DROPPED,              COUNTER,    "log",      "dropped")
+
+#define APP_METRICS_ENUM(id, type, module, name)    APP_METRIC_##id,
+
+typedef enum
+{
+    APP_METRICS_LIST(APP_METRICS_ENUM)
+    APP_METRIC_COUNT
+} app_metric_id_t;
+
+typedef enum
+{
+    APP_METRIC_TYPE_COUNTER = 0,
+    APP_METRIC_TYPE_GAUGE   = 1
+} app_metric_type_t;
+
+/*********************************************************************
+*
+*      Query protocol
+*
+*  A snapshot is read with a vendor request on EP0, addressed to a
+*  vendor specific interface of its own. The CDC interfaces and the
+*  bulk data path are not involved, and the CDC driver of the host
+*  keeps them:
+*
+*    bmRequestType  APP_METRICS_REQUEST_TYPE (device to host, vendor,
+*                   interface)
+*    bRequest       APP_METRICS_REQ_SNAPSHOT
+*    wValue         index of the first metric
+*    wIndex         APP_METRICS_INTERFACE
+*    wLength        size of the host buffer
+*
+*  The response is an APP_METRICS_HEADER followed by count values of
+*  32 bits, as many as fit into wLength. All fields are little endian.
+*  Each value is read atomically, but the snapshot is not a consistent
+*  cut across all metrics.
+*
+**********************************************************************/
+#define APP_METRICS_MAGIC           (0x544DU)   /* "MT" */
+#define APP_METRICS_VERSION         (1U)
+
+#define APP_METRICS_REQUEST_TYPE    (0xC1U)
+#define APP_METRICS_REQ_SNAPSHOT    (0x01U)
+
+/* The device adds the metrics interface after the CDC control (0) and data (1)
+ * interfaces, and interfaces are numbered in the order they are added */
+#ifndef APP_METRICS_INTERFACE
+#define APP_METRICS_INTERFACE       (2U)
+#endif
+
+typedef struct
+{
+    uint16_t magic;             /* APP_METRICS_MAGIC */
+    uint8_t  version;           /* APP_METRICS_VERSION */
+    uint8_t  total;             /* Number of metrics of the firmware */
+    uint8_t  first;             /* Index of the first value in this response */
+    uint8_t  count;             /* Number of values following the header */
+    uint16_t sequence;          /* Incremented per snapshot */
+    uint32_t uptime_ms;         /* Time of the snapshot, in milliseconds since start-up */
+} APP_METRICS_HEADER;
+
+#endif /* APP_METRICS_FORMAT_H */
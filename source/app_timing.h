@@ -0,0 +1,110 @@
+/*********************************************************************************
+* File Name        :   app_timing.h
+*
+* Description      :   Cycle accurate time stamps based on the Cortex-M4 DWT
+*                      cycle counter
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef APP_TIMING_H
+#define APP_TIMING_H
+
+#include <stdint.h>
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+/***********************************************************************************
+ *  Function Name: app_timing_init
+ ***********************************************************************************
+ * Summary:
+ * Enables the DWT cycle counter. Safe to call more than once.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static inline void app_timing_init(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0U)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0U;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: app_timing_now
+ ***********************************************************************************
+ * Summary:
+ * Returns the current CPU cycle count. The counter wraps every 2^32 cycles
+ * (~35 s at 120 MHz), so only differences of nearby time stamps are meaningful.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * uint32_t - current cycle count
+ *
+ **********************************************************************************/
+static inline uint32_t app_timing_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/***********************************************************************************
+ *  Function Name: app_timing_cycles_to_us
+ ***********************************************************************************
+ * Summary:
+ * Converts a cycle count difference into microseconds.
+ *
+ * Parameters:
+ * cycles - number of CPU cycles
+ *
+ * Return:
+ * uint32_t - elapsed time in microseconds
+ *
+ **********************************************************************************/
+static inline uint32_t app_timing_cycles_to_us(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000U) / SystemCoreClock);
+}
+
+#endif /* APP_TIMING_H */
@@ -0,0 +1,428 @@
+/*********************************************************************************
+* File Name        :   cdc_host_rto.c
+*
+* Description      :   Adaptive timeout and retry policy of the CDC host client.
+*                      Derives per-device transfer timeouts from the measured
+*                      transfer times (smoothed RTT and variation, as in RFC 6298)
+*                      and retries timed out transfers with bounded backoff.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "cdc_host_rto.h"
+
+#include "app_config.h"
+#include "app_log.h"
+#include "app_metrics.h"
+#include "app_timing.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static cdc_host_rto_stats_t rto_stats[APP_CDC_MAX_DEVICES];
+
+/***********************************************************************************
+ *  Function Name: rto_slot
+ ***********************************************************************************
+ * Summary:
+ * Maps a device index to its statistics. Indices beyond APP_CDC_MAX_DEVICES,
+ * including the index of a removed device, are rejected, so they cannot change
+ * the estimator of another device.
+ *
+ * Parameters:
+ * index - device index
+ *
+ * Return:
+ * cdc_host_rto_stats_t* - statistics of the device, NULL if the index is invalid
+ *
+ **********************************************************************************/
+static cdc_host_rto_stats_t* rto_slot(uint8_t index)
+{
+    if (index >= APP_CDC_MAX_DEVICES)
+    {
+        APP_LOG_ERROR("CDC timeout: invalid device index %u", index);
+        return NULL;
+    }
+
+    return &rto_stats[index];
+}
+
+/***********************************************************************************
+ *  Function Name: rto_update
+ ***********************************************************************************
+ * Summary:
+ * Feeds one measured transfer time into the estimator and derives the new
+ * timeout: RTO = SRTT + 4 * RTTVAR, clamped to the configured limits.
+ *
+ * Parameters:
+ * slot   - statistics of the device
+ * rtt_us - measured transfer time in microseconds
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void rto_update(cdc_host_rto_stats_t* slot, uint32_t rtt_us)
+{
+    uint32_t rto_us;
+    uint32_t delta;
+
+    if ((slot->rtt_min_us == 0U) || (rtt_us < slot->rtt_min_us))
+    {
+        slot->rtt_min_us = rtt_us;
+    }
+    if (rtt_us > slot->rtt_max_us)
+    {
+        slot->rtt_max_us = rtt_us;
+    }
+
+    if (slot->transfers == 0U)
+    {
+        slot->srtt_us   = rtt_us;
+        slot->rttvar_us = rtt_us / 2U;
+    }
+    else
+    {
+        delta = (slot->srtt_us > rtt_us) ? (slot->srtt_us - rtt_us) : (rtt_us - slot->srtt_us);
+        slot->rttvar_us = ((3U * slot->rttvar_us) + delta) / 4U;
+        slot->srtt_us   = ((7U * slot->srtt_us) + rtt_us) / 8U;
+    }
+    slot->transfers++;
+
+    rto_us = slot->srtt_us + (4U * slot->rttvar_us);
+    slot->rto_ms = (rto_us + 999U) / 1000U;
+
+    if (slot->rto_ms < APP_CDC_RTO_MIN_MS)
+    {
+        slot->rto_ms = APP_CDC_RTO_MIN_MS;
+    }
+    else if (slot->rto_ms > APP_CDC_RTO_MAX_MS)
+    {
+        slot->rto_ms = APP_CDC_RTO_MAX_MS;
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: rto_backoff
+ ***********************************************************************************
+ * Summary:
+ * Handles a timed out attempt: doubles the timeout (bounded) and waits before the
+ * retry.
+ *
+ * Parameters:
+ * slot    - statistics of the device
+ * attempt - number of retries done so far
+ *
+ * Return:
+ * bool - false once the retries are exhausted
+ *
+ **********************************************************************************/
+static bool rto_backoff(cdc_host_rto_stats_t* slot, uint32_t attempt)
+{
+    uint32_t delay_ms;
+
+    slot->timeouts++;
+    app_metrics_inc(APP_METRIC_HOST_TIMEOUTS);
+
+    slot->rto_ms *= 2U;
+    if (slot->rto_ms > APP_CDC_RTO_MAX_MS)
+    {
+        slot->rto_ms = APP_CDC_RTO_MAX_MS;
+    }
+
+    if (attempt >= APP_CDC_MAX_RETRIES)
+    {
+        return false;
+    }
+
+    delay_ms = APP_CDC_RETRY_BACKOFF_MS << attempt;
+    if (delay_ms > APP_CDC_RETRY_BACKOFF_MAX_MS)
+    {
+        delay_ms = APP_CDC_RETRY_BACKOFF_MAX_MS;
+    }
+
+    slot->retries++;
+    app_metrics_inc(APP_METRIC_HOST_RETRIES);
+    USBH_OS_Delay(delay_ms);
+
+    return true;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_reset
+ ***********************************************************************************
+ * Summary:
+ * Forgets the measurements of a device. Call when a device is added.
+ *
+ * Parameters:
+ * index - device index from the notification callback
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_host_rto_reset(uint8_t index)
+{
+    cdc_host_rto_stats_t* slot = rto_slot(index);
+
+    app_timing_init();
+
+    if (slot == NULL)
+    {
+        return;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    slot->rto_ms = APP_CDC_RTO_INITIAL_MS;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_get_timeout
+ ***********************************************************************************
+ * Summary:
+ * Returns the timeout currently derived for a device.
+ *
+ * Parameters:
+ * index - device index
+ *
+ * Return:
+ * uint32_t - timeout in ms, APP_CDC_RTO_INITIAL_MS for an invalid index
+ *
+ **********************************************************************************/
+uint32_t cdc_host_rto_get_timeout(uint8_t index)
+{
+    const cdc_host_rto_stats_t* slot = rto_slot(index);
+
+    return (slot != NULL) ? slot->rto_ms : APP_CDC_RTO_INITIAL_MS;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the timeout and retry statistics of a device. The copy is
+ * zeroed for an invalid index.
+ *
+ * Parameters:
+ * index - device index
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_host_rto_get_stats(uint8_t index, cdc_host_rto_stats_t* stats)
+{
+    const cdc_host_rto_stats_t* slot = rto_slot(index);
+
+    if (slot == NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    *stats = *slot;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the timeout and retry statistics of a device.
+ *
+ * Parameters:
+ * index - device index
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_host_rto_report(uint8_t index)
+{
+    const cdc_host_rto_stats_t* slot = rto_slot(index);
+
+    if (slot == NULL)
+    {
+        return;
+    }
+
+    APP_LOG_INFO("Device [%u]: %lu transfers, %lu timeouts, %lu retries, %lu failures",
+                 index, (unsigned long)slot->transfers, (unsigned long)slot->timeouts,
+                 (unsigned long)slot->retries, (unsigned long)slot->failures);
+    APP_LOG_INFO("Device [%u]: RTT min %lu us, max %lu us, srtt %lu us, rttvar %lu us, timeout %lu ms",
+                 index, (unsigned long)slot->rtt_min_us, (unsigned long)slot->rtt_max_us,
+                 (unsigned long)slot->srtt_us, (unsigned long)slot->rttvar_us,
+                 (unsigned long)slot->rto_ms);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_write
+ ***********************************************************************************
+ * Summary:
+ * Writes data to a CDC device with the adaptive timeout. Timed out attempts are
+ * retried for the remaining bytes with bounded exponential backoff.
+ *
+ * Parameters:
+ * handle    - handle returned by USBH_CDC_Open()
+ * index     - device index
+ * data      - data to write
+ * length    - number of bytes to write
+ * num_bytes - receives the number of bytes written
+ *
+ * Return:
+ * USBH_STATUS - USBH_STATUS_SUCCESS if all bytes were written
+ *
+ **********************************************************************************/
+USBH_STATUS cdc_host_rto_write(USBH_CDC_HANDLE handle, uint8_t index, const uint8_t* data,
+                               uint32_t length, uint32_t* num_bytes)
+{
+    cdc_host_rto_stats_t  unknown = { .rto_ms = APP_CDC_RTO_INITIAL_MS };
+    cdc_host_rto_stats_t* slot = rto_slot(index);
+    USBH_STATUS usb_status;
+    U32         written;
+    uint32_t    total = 0U;
+    uint32_t    attempt = 0U;
+    uint32_t    start;
+
+    /* An invalid index transfers with the initial timeout, nothing is recorded */
+    if (slot == NULL)
+    {
+        slot = &unknown;
+    }
+
+    for (;;)
+    {
+        written = 0U;
+        USBH_CDC_SetTimeouts(handle, slot->rto_ms, slot->rto_ms);
+
+        start = app_timing_now();
+        usb_status = USBH_CDC_Write(handle, &data[total], length - total, &written);
+        total += written;
+
+        if (usb_status == USBH_STATUS_SUCCESS)
+        {
+            rto_update(slot, app_timing_cycles_to_us(app_timing_now() - start));
+            break;
+        }
+
+        if ((usb_status != USBH_STATUS_TIMEOUT) || !rto_backoff(slot, attempt))
+        {
+            slot->failures++;
+            app_metrics_inc(APP_METRIC_HOST_FAILURES);
+            break;
+        }
+        attempt++;
+    }
+
+    app_metrics_add(APP_METRIC_HOST_TX_BYTES, total);
+    *num_bytes = total;
+    return usb_status;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_host_rto_read
+ ***********************************************************************************
+ * Summary:
+ * Reads data from a CDC device with the adaptive timeout. A timeout that returned
+ * data counts as success (short read), but does not update the estimator. Timed
+ * out attempts without data are retried with bounded exponential backoff.
+ *
+ * Parameters:
+ * handle    - handle returned by USBH_CDC_Open()
+ * index     - device index
+ * data      - destination buffer
+ * length    - size of the buffer
+ * num_bytes - receives the number of bytes read
+ *
+ * Return:
+ * USBH_STATUS - USBH_STATUS_SUCCESS if data was read
+ *
+ **********************************************************************************/
+USBH_STATUS cdc_host_rto_read(USBH_CDC_HANDLE handle, uint8_t index, uint8_t* data,
+                              uint32_t length, uint32_t* num_bytes)
+{
+    cdc_host_rto_stats_t  unknown = { .rto_ms = APP_CDC_RTO_INITIAL_MS };
+    cdc_host_rto_stats_t* slot = rto_slot(index);
+    USBH_STATUS usb_status;
+    U32         received;
+    uint32_t    attempt = 0U;
+    uint32_t    start;
+
+    /* An invalid index transfers with the initial timeout, nothing is recorded */
+    if (slot == NULL)
+    {
+        slot = &unknown;
+    }
+
+    for (;;)
+    {
+        received = 0U;
+        USBH_CDC_SetTimeouts(handle, slot->rto_ms, slot->rto_ms);
+
+        start = app_timing_now();
+        usb_status = USBH_CDC_Read(handle, data, length, &received);
+
+        if (usb_status == USBH_STATUS_SUCCESS)
+        {
+            rto_update(slot, app_timing_cycles_to_us(app_timing_now() - start));
+            break;
+        }
+
+        /* A timeout that returned data is a short read. Its duration is the
+         * timeout, not a transfer time, so it is no sample (Karn's algorithm). */
+        if ((usb_status == USBH_STATUS_TIMEOUT) && (received > 0U))
+        {
+            usb_status = USBH_STATUS_SUCCESS;
+            break;
+        }
+
+        if ((usb_status != USBH_STATUS_TIMEOUT) || !rto_backoff(slot, attempt))
+        {
+            slot->failures++;
+            app_metrics_inc(APP_METRIC_HOST_FAILURES);
+            break;
+        }
+        attempt++;
+    }
+
+    app_metrics_add(APP_METRIC_HOST_RX_BYTES, received);
+    *num_bytes = received;
+    return usb_status;
+}
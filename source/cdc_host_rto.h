@@ -0,0 +1,77 @@
+/*********************************************************************************
+* File Name        :   cdc_host_rto.h
+*
+* Description      :   Interface of the adaptive timeout and retry policy of the
+*                      CDC host client
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CDC_HOST_RTO_H
+#define CDC_HOST_RTO_H
+
+#include <stdint.h>
+
+/* emUSB-Host header file includes */
+#include "USBH.h"
+#include "USBH_CDC.h"
+
+typedef struct
+{
+    uint32_t transfers;         /* Completed transfers */
+    uint32_t timeouts;          /* Attempts that ran into the timeout */
+    uint32_t retries;           /* Attempts repeated after a timeout */
+    uint32_t failures;          /* Transfers that failed after all retries or with an error */
+    uint32_t rtt_min_us;        /* Shortest measured transfer time */
+    uint32_t rtt_max_us;        /* Longest measured transfer time */
+    uint32_t srtt_us;           /* Smoothed transfer time */
+    uint32_t rttvar_us;         /* Transfer time variation */
+    uint32_t rto_ms;            /* Timeout currently applied to the device */
+} cdc_host_rto_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void        cdc_host_rto_reset(uint8_t index);
+uint32_t    cdc_host_rto_get_timeout(uint8_t index);
+void        cdc_host_rto_get_stats(uint8_t index, cdc_host_rto_stats_t* stats);
+void        cdc_host_rto_report(uint8_t index);
+
+USBH_STATUS cdc_host_rto_write(USBH_CDC_HANDLE handle, uint8_t index, const uint8_t* data,
+                               uint32_t length, uint32_t* num_bytes);
+USBH_STATUS cdc_host_rto_read(USBH_CDC_HANDLE handle, uint8_t index, uint8_t* data,
+                              uint32_t length, uint32_t* num_bytes);
+
+#endif /* CDC_HOST_RTO_H */
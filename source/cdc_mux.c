@@ -0,0 +1,711 @@
+/*********************************************************************************
+* File Name        :   cdc_mux.c
+*
+* Description      :   Host fan-in multiplexer. Reads all attached CDC devices
+*                      continuously and writes the data, tagged with the device index
+*                      and a timestamp, as one stream of framed batches to a sink.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cdc_mux.h"
+
+#if (APP_CDC_MUX_ENABLE)
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+/* emUSB-Host header file includes */
+#include "USBH.h"
+#include "USBH_CDC.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_log.h"
+#include "app_metrics.h"
+#include "otg_session.h"
+#include "stream_kernels.h"
+#include "usb_pool.h"
+
+/* A batch is checksummed and encoded in place, so each buffer has room for the
+ * worst case frame */
+#define CDC_MUX_FRAME_SIZE          (STREAM_COBS_MAX_SIZE(STREAM_CHECKSUM_MAX_SIZE(APP_CDC_MUX_BATCH_SIZE)))
+
+typedef struct
+{
+    volatile bool attached;
+    bool          dropped;          /* Flag the next record of this device */
+    TickType_t    attach_tick;
+} mux_source_t;
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static mux_source_t      mux_sources[APP_CDC_MAX_DEVICES];
+static TaskHandle_t      mux_readers[APP_CDC_MAX_DEVICES];
+static TaskHandle_t      mux_flusher;
+static cdc_mux_stats_t   mux_stats;
+
+/* Double buffered batches: readers fill one while the flush task sends the other */
+static uint8_t           mux_batch[2][CDC_MUX_FRAME_SIZE];
+static uint32_t          mux_fill;              /* Index of the batch being filled */
+static uint32_t          mux_fill_length;       /* Bytes in the batch being filled, header included */
+static uint16_t          mux_fill_records;
+static volatile uint32_t mux_writers[2];        /* Readers still copying a reserved record into the batch */
+static volatile bool     mux_flush_pending;     /* The other batch is complete and waits for the flush task */
+static uint32_t          mux_flush_length;
+static uint16_t          mux_sequence;
+
+static volatile bool     mux_stopping;          /* Readers close their devices and exit */
+static volatile bool     mux_flush_stop;        /* Flush task sends the remaining data and exits */
+static volatile uint32_t mux_tasks_running;
+
+#if (APP_CDC_MUX_SINK == APP_CDC_MUX_SINK_RAM)
+static uint8_t           mux_ring[APP_CDC_MUX_RING_SIZE];
+static volatile uint32_t mux_ring_head;         /* Free running write index, flush task only */
+static volatile uint32_t mux_ring_tail;         /* Free running read index, cdc_mux_ring_read() only */
+#endif
+
+/***********************************************************************************
+ *  Function Name: mux_batch_complete
+ ***********************************************************************************
+ * Summary:
+ * Completes the batch being filled and hands it to the flush task, which sends
+ * it once the copies of all its writers are done. Must be called in a critical
+ * section, with records in the batch and no batch pending.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void mux_batch_complete(void)
+{
+    CDC_MUX_HEADER header =
+    {
+        .magic        = CDC_MUX_MAGIC,
+        .version      = CDC_MUX_VERSION,
+        .flags        = 0U,
+        .sequence     = mux_sequence++,
+        .record_count = mux_fill_records
+    };
+
+    memcpy(mux_batch[mux_fill], &header, sizeof(header));
+    mux_flush_length  = mux_fill_length;
+    mux_flush_pending = true;
+
+    mux_fill        ^= 1U;
+    mux_fill_length  = sizeof(CDC_MUX_HEADER);
+    mux_fill_records = 0U;
+}
+
+/***********************************************************************************
+ *  Function Name: mux_put
+ ***********************************************************************************
+ * Summary:
+ * Appends the data of one read as a record to the current batch. A full batch
+ * is handed to the flush task. If the flush task is still busy with the
+ * previous batch, the data is dropped and counted, so a slow sink never blocks
+ * the readers. Only the space is reserved in a critical section; the record is
+ * copied with interrupts enabled.
+ *
+ * Parameters:
+ * index  - device index
+ * data   - data read from the device
+ * length - number of bytes, at most APP_CDC_MUX_READ_SIZE
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void mux_put(uint8_t index, const uint8_t* data, uint32_t length)
+{
+    mux_source_t*           source = &mux_sources[index];
+    cdc_mux_source_stats_t* stats  = &mux_stats.sources[index];
+    uint32_t                size   = sizeof(CDC_MUX_RECORD) + length;
+    uint8_t*                slot   = NULL;
+    uint32_t                batch  = 0U;
+    bool                    flush  = false;
+    CDC_MUX_RECORD          record =
+    {
+        .index        = index,
+        .flags        = 0U,
+        .length       = (uint16_t)length,
+        .timestamp_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS
+    };
+
+    taskENTER_CRITICAL();
+
+    if (((mux_fill_length + size) > APP_CDC_MUX_BATCH_SIZE) && !mux_flush_pending)
+    {
+        mux_batch_complete();
+        flush = true;
+    }
+
+    if ((mux_fill_length + size) <= APP_CDC_MUX_BATCH_SIZE)
+    {
+        batch = mux_fill;
+        slot  = &mux_batch[batch][mux_fill_length];
+        mux_writers[batch]++;
+
+        record.flags = source->dropped ? CDC_MUX_FLAG_DROPPED : 0U;
+        mux_fill_length += size;
+        mux_fill_records++;
+        source->dropped = false;
+
+        stats->records++;
+        stats->bytes += length;
+        app_metrics_add(APP_METRIC_MUX_BYTES, length);
+    }
+    else
+    {
+        source->dropped = true;
+        stats->dropped_records++;
+        stats->dropped_bytes += length;
+        app_metrics_add(APP_METRIC_MUX_DROPPED_BYTES, length);
+    }
+
+    taskEXIT_CRITICAL();
+
+    if (slot != NULL)
+    {
+        memcpy(slot, &record, sizeof(record));
+        memcpy(&slot[sizeof(record)], data, length);
+
+        /* The last writer of a batch completed in the meantime wakes the flush task */
+        taskENTER_CRITICAL();
+        mux_writers[batch]--;
+        if ((mux_writers[batch] == 0U) && (batch != mux_fill))
+        {
+            flush = true;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if (flush)
+    {
+        xTaskNotifyGive(mux_flusher);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: mux_sink_write
+ ***********************************************************************************
+ * Summary:
+ * Writes one frame to the sink. The RAM sink stores whole frames only; a frame
+ * that does not fit is dropped and counted.
+ *
+ * Parameters:
+ * frame  - encoded frame, ending with a zero byte
+ * length - number of bytes
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void mux_sink_write(const uint8_t* frame, uint32_t length)
+{
+#if (APP_CDC_MUX_SINK == APP_CDC_MUX_SINK_RAM)
+    uint32_t head   = mux_ring_head;
+    uint32_t offset = head & (APP_CDC_MUX_RING_SIZE - 1U);
+    uint32_t first  = APP_CDC_MUX_RING_SIZE - offset;
+
+    if ((APP_CDC_MUX_RING_SIZE - (head - mux_ring_tail)) < length)
+    {
+        mux_stats.frames_dropped++;
+        app_metrics_inc(APP_METRIC_MUX_FRAMES_DROPPED);
+        return;
+    }
+
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(&mux_ring[offset], frame, first);
+    memcpy(mux_ring, &frame[first], length - first);
+
+    /* Publish the frame only after it was copied */
+    portMEMORY_BARRIER();
+    mux_ring_head = head + length;
+#else
+    /* retarget-io blocks until the frame was sent. The lock keeps log messages
+     * out of the frame. */
+    app_log_lock();
+    (void)fwrite(frame, 1U, length, stdout);
+    (void)fflush(stdout);
+    app_log_unlock();
+#endif
+
+    mux_stats.frames++;
+    app_metrics_inc(APP_METRIC_MUX_FRAMES);
+    mux_stats.frame_bytes += length;
+}
+
+/***********************************************************************************
+ *  Function Name: mux_flush_task
+ ***********************************************************************************
+ * Summary:
+ * Encodes complete batches and writes them to the sink, once no reader is
+ * copying into them any more. A partially filled batch is completed after
+ * APP_CDC_MUX_FLUSH_MS, so data of slow devices is not held back.
+ *
+ * Parameters:
+ * arg - is not used in this function, is required by FreeRTOS
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void mux_flush_task(void* arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_CDC_MUX_FLUSH_MS));
+
+        taskENTER_CRITICAL();
+        if (!mux_flush_pending && (mux_fill_records != 0U))
+        {
+            mux_batch_complete();
+        }
+        taskEXIT_CRITICAL();
+
+        /* No new records are reserved in the pending batch, so its writer count
+         * only goes down; the last writer notifies this task */
+        if (mux_flush_pending && (mux_writers[mux_fill ^ 1U] == 0U))
+        {
+            /* The pending batch is not touched by the readers until the flag is cleared */
+            uint8_t* frame  = mux_batch[mux_fill ^ 1U];
+            uint32_t length = stream_checksum_append(frame, mux_flush_length, CDC_MUX_FRAME_SIZE);
+
+            length = stream_cobs_encode(frame, length, CDC_MUX_FRAME_SIZE);
+
+            mux_sink_write(frame, length);
+            mux_flush_pending = false;
+        }
+
+        if (mux_flush_stop && !mux_flush_pending && (mux_fill_records == 0U))
+        {
+            break;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    mux_tasks_running--;
+    taskEXIT_CRITICAL();
+
+    vTaskDelete(NULL);
+}
+
+/***********************************************************************************
+ *  Function Name: mux_reader_task
+ ***********************************************************************************
+ * Summary:
+ * Reads one device slot. Waits until a device is attached to the slot, then
+ * reads continuously until it is removed. The read timeout is short and fixed:
+ * an idle device is normal here, and the timeout bounds the reaction time to a
+ * removal or to cdc_mux_stop(). After a failed open or read, the device is
+ * opened again every APP_CDC_MUX_RETRY_MS while it stays attached.
+ *
+ * Parameters:
+ * arg - device index
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void mux_reader_task(void* arg)
+{
+    uint8_t       index  = (uint8_t)(uintptr_t)arg;
+    mux_source_t* source = &mux_sources[index];
+    uint8_t       buffer[APP_CDC_MUX_READ_SIZE];
+
+    while (!mux_stopping)
+    {
+        USBH_CDC_HANDLE handle;
+
+        if (!source->attached)
+        {
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        handle = USBH_CDC_Open(index);
+        if (handle == 0)
+        {
+            APP_LOG_ERROR("CDC mux [%u]: open failed, retrying", (unsigned)index);
+            (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_CDC_MUX_RETRY_MS));
+            continue;
+        }
+        otg_session_handle_opened();
+
+        USBH_CDC_SetTimeouts(handle, APP_CDC_MUX_READ_TIMEOUT_MS, APP_CDC_MUX_READ_TIMEOUT_MS);
+        USBH_CDC_AllowShortRead(handle, 1);
+        USBH_CDC_SetCommParas(handle, USBH_CDC_BAUD_115200, USBH_CDC_BITS_8,
+                              USBH_CDC_STOP_BITS_1, USBH_CDC_PARITY_NONE);
+
+        while (source->attached && !mux_stopping)
+        {
+            U32         received   = 0U;
+            USBH_STATUS usb_status = USBH_CDC_Read(handle, buffer, sizeof(buffer), &received);
+
+            if (received != 0U)
+            {
+                mux_put(index, buffer, received);
+            }
+
+            if ((usb_status != USBH_STATUS_SUCCESS) && (usb_status != USBH_STATUS_TIMEOUT))
+            {
+                if ((usb_status == USBH_STATUS_DEVICE_REMOVED) || !source->attached)
+                {
+                    APP_LOG_INFO("CDC mux [%u]: device removed", (unsigned)index);
+                }
+                else
+                {
+                    APP_LOG_ERROR("CDC mux [%u]: read failed, status %d", (unsigned)index, (int)usb_status);
+                }
+                break;
+            }
+        }
+
+        /* emUSB-Host frees a removed device only after it is closed */
+        USBH_CDC_Close(handle);
+        otg_session_handle_closed();
+
+        /* A read error: reopen the device while it is still attached.
+         * cdc_mux_stop() or a new attach ends the delay early. */
+        if (source->attached && !mux_stopping)
+        {
+            APP_LOG_ERROR("CDC mux [%u]: reopening in %u ms", (unsigned)index, (unsigned)APP_CDC_MUX_RETRY_MS);
+            (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_CDC_MUX_RETRY_MS));
+        }
+    }
+
+    taskENTER_CRITICAL();
+    mux_tasks_running--;
+    taskEXIT_CRITICAL();
+
+    vTaskDelete(NULL);
+}
+
+/***********************************************************************************
+ *  Function Name: mux_create_task
+ ***********************************************************************************
+ * Summary:
+ * Creates a multiplexer task in the session pool.
+ *
+ * Parameters:
+ * task        - task function
+ * name        - task name
+ * stack_depth - stack size in words
+ * arg         - argument of the task function
+ * priority    - task priority
+ *
+ * Return:
+ * TaskHandle_t - handle of the task
+ *
+ **********************************************************************************/
+static TaskHandle_t mux_create_task(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                                    void* arg, UBaseType_t priority)
+{
+    TaskHandle_t handle;
+
+    taskENTER_CRITICAL();
+    mux_tasks_running++;
+    taskEXIT_CRITICAL();
+
+    handle = usb_pool_create_task(task, name, stack_depth, arg, priority);
+    if (handle == NULL)
+    {
+        CY_ASSERT(0);
+    }
+
+    return handle;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_start
+ ***********************************************************************************
+ * Summary:
+ * Starts the multiplexer for a host session: one reader task per device slot
+ * and the flush task. Called after emUSB-Host was started.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_start(void)
+{
+    uint32_t i;
+
+    memset(mux_sources, 0, sizeof(mux_sources));
+    memset(&mux_stats, 0, sizeof(mux_stats));
+    memset((void*)mux_writers, 0, sizeof(mux_writers));
+    mux_fill          = 0U;
+    mux_fill_length   = sizeof(CDC_MUX_HEADER);
+    mux_fill_records  = 0U;
+    mux_flush_pending = false;
+    mux_sequence      = 0U;
+    mux_stopping      = false;
+    mux_flush_stop    = false;
+
+    for (i = 0U; i < APP_CDC_MAX_DEVICES; i++)
+    {
+        mux_readers[i] = mux_create_task(mux_reader_task, "cdc_mux_reader", APP_CDC_MUX_READER_STACK_SIZE,
+                                         (void*)(uintptr_t)i, APP_PRIO_CDC_MUX_READER);
+    }
+
+    mux_flusher = mux_create_task(mux_flush_task, "cdc_mux_flush", APP_CDC_MUX_FLUSH_STACK_SIZE,
+                                  NULL, APP_PRIO_CDC_MUX_FLUSH);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_stop
+ ***********************************************************************************
+ * Summary:
+ * Stops the multiplexer. The readers close their devices, then the remaining
+ * data is sent. Returns when all tasks have exited; must be called before
+ * emUSB-Host is deinitialized.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_stop(void)
+{
+    uint32_t i;
+
+    mux_stopping = true;
+    for (i = 0U; i < APP_CDC_MAX_DEVICES; i++)
+    {
+        cdc_mux_detach((uint8_t)i);
+        xTaskNotifyGive(mux_readers[i]);
+    }
+
+    /* Only the flush task is left when all readers have exited */
+    while (mux_tasks_running > 1U)
+    {
+        vTaskDelay(1U);
+    }
+
+    mux_flush_stop = true;
+    xTaskNotifyGive(mux_flusher);
+
+    while (mux_tasks_running > 0U)
+    {
+        vTaskDelay(1U);
+    }
+
+    cdc_mux_report();
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_attach
+ ***********************************************************************************
+ * Summary:
+ * Starts reading a device. Called from the emUSB-Host device notification.
+ *
+ * Parameters:
+ * index - device index
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_attach(uint8_t index)
+{
+    if (index >= APP_CDC_MAX_DEVICES)
+    {
+        APP_LOG_ERROR("CDC mux [%u]: ignored, only %u devices are supported",
+                      (unsigned)index, (unsigned)APP_CDC_MAX_DEVICES);
+        return;
+    }
+
+    mux_sources[index].attach_tick = xTaskGetTickCount();
+    mux_sources[index].attached    = true;
+    xTaskNotifyGive(mux_readers[index]);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_detach
+ ***********************************************************************************
+ * Summary:
+ * Stops reading a device. The reader closes the device after the current read.
+ *
+ * Parameters:
+ * index - device index
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_detach(uint8_t index)
+{
+    mux_source_t* source;
+
+    if (index >= APP_CDC_MAX_DEVICES)
+    {
+        return;
+    }
+
+    source = &mux_sources[index];
+    if (source->attached)
+    {
+        source->attached = false;
+        mux_stats.sources[index].attached_ms += (uint32_t)(xTaskGetTickCount() - source->attach_tick) *
+                                                portTICK_PERIOD_MS;
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_ring_read
+ ***********************************************************************************
+ * Summary:
+ * Reads the stream from the RAM sink. Only one task may read. Without the RAM
+ * sink, nothing is read.
+ *
+ * Parameters:
+ * data - destination
+ * size - capacity of data
+ *
+ * Return:
+ * uint32_t - number of bytes read
+ *
+ **********************************************************************************/
+uint32_t cdc_mux_ring_read(uint8_t* data, uint32_t size)
+{
+#if (APP_CDC_MUX_SINK == APP_CDC_MUX_SINK_RAM)
+    uint32_t tail   = mux_ring_tail;
+    uint32_t count  = mux_ring_head - tail;
+    uint32_t offset = tail & (APP_CDC_MUX_RING_SIZE - 1U);
+    uint32_t first  = APP_CDC_MUX_RING_SIZE - offset;
+
+    /* Read the data before the index, see mux_sink_write() */
+    portMEMORY_BARRIER();
+
+    if (count > size)
+    {
+        count = size;
+    }
+    if (first > count)
+    {
+        first = count;
+    }
+    memcpy(data, &mux_ring[offset], first);
+    memcpy(&data[first], mux_ring, count - first);
+
+    mux_ring_tail = tail + count;
+    return count;
+#else
+    (void)data;
+    (void)size;
+    return 0U;
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the statistics of the current or last host session.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_get_stats(cdc_mux_stats_t* stats)
+{
+    *stats = mux_stats;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_mux_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the throughput and drops of each device that was attached, and the
+ * frames written to the sink.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_mux_report(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < APP_CDC_MAX_DEVICES; i++)
+    {
+        const cdc_mux_source_stats_t* stats = &mux_stats.sources[i];
+
+        if (stats->attached_ms == 0U)
+        {
+            continue;
+        }
+
+        APP_LOG_INFO("CDC mux [%lu]: %lu bytes in %lu records, %lu B/s, dropped %lu bytes in %lu records",
+                     (unsigned long)i, (unsigned long)stats->bytes, (unsigned long)stats->records,
+                     (unsigned long)(((uint64_t)stats->bytes * 1000U) / stats->attached_ms),
+                     (unsigned long)stats->dropped_bytes, (unsigned long)stats->dropped_records);
+    }
+
+    APP_LOG_INFO("CDC mux sink: %lu frames, %lu bytes, %lu frames dropped",
+                 (unsigned long)mux_stats.frames, (unsigned long)mux_stats.frame_bytes,
+                 (unsigned long)mux_stats.frames_dropped);
+}
+
+#endif /* APP_CDC_MUX_ENABLE */
@@ -0,0 +1,88 @@
+/*********************************************************************************
+* File Name        :   cdc_mux.h
+*
+* Description      :   Public API of the CDC host fan-in multiplexer
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CDC_MUX_H
+#define CDC_MUX_H
+
+#include <stdint.h>
+
+#include "app_config.h"
+#include "cdc_mux_format.h"
+
+typedef struct
+{
+    uint32_t records;           /* Records added to a batch */
+    uint32_t bytes;             /* Data bytes added to a batch */
+    uint32_t dropped_records;   /* Reads dropped, the batch was full and the previous one not sent yet */
+    uint32_t dropped_bytes;     /* Data bytes of the dropped reads */
+    uint32_t attached_ms;       /* Time the device was attached, for the throughput */
+} cdc_mux_source_stats_t;
+
+typedef struct
+{
+    cdc_mux_source_stats_t sources[APP_CDC_MAX_DEVICES];
+    uint32_t frames;            /* Frames written to the sink */
+    uint32_t frame_bytes;       /* Encoded bytes written to the sink */
+    uint32_t frames_dropped;    /* Frames dropped, the RAM sink was full */
+} cdc_mux_stats_t;
+
+#if (APP_CDC_MUX_ENABLE)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void     cdc_mux_start(void);
+void     cdc_mux_stop(void);
+void     cdc_mux_attach(uint8_t index);
+void     cdc_mux_detach(uint8_t index);
+uint32_t cdc_mux_ring_read(uint8_t* data, uint32_t size);
+void     cdc_mux_get_stats(cdc_mux_stats_t* stats);
+void     cdc_mux_report(void);
+
+#else
+
+#define cdc_mux_start()             do { } while (0)
+#define cdc_mux_stop()              do { } while (0)
+#define cdc_mux_attach(index)       do { (void)(index); } while (0)
+#define cdc_mux_detach(index)       do { (void)(index); } while (0)
+
+#endif /* APP_CDC_MUX_ENABLE */
+
+#endif /* CDC_MUX_H */
@@ -0,0 +1,88 @@
+/*********************************************************************************
+* File Name        :   cdc_mux_format.h
+*
+* Description      :   Framing of the CDC host fan-in stream. Shared between the
+*                      firmware multiplexer and PC side decoders, so this header must
+*                      not depend on any target specific header.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CDC_MUX_FORMAT_H
+#define CDC_MUX_FORMAT_H
+
+#include <stdint.h>
+
+/*********************************************************************
+*
+*      Stream layout
+*
+*  The stream is a sequence of frames. Each frame is one batch encoded
+*  with COBS and terminated by a zero byte, so a decoder can start at
+*  any point of the stream and resynchronizes at the next zero byte.
+*
+*  A batch is a CDC_MUX_HEADER followed by record_count records and a
+*  checksum. Each record is a CDC_MUX_RECORD followed by length bytes of
+*  data read from one device, without padding. The checksum is the 16-bit
+*  sum of all bytes of the header and the records (stream_checksum_append()
+*  in stream_kernels.c). A decoder drops frames with a wrong checksum, for
+*  example frames corrupted by other output on a shared UART. All fields
+*  are little endian.
+*
+**********************************************************************/
+#define CDC_MUX_MAGIC               (0x584DU)   /* "MX" */
+#define CDC_MUX_VERSION             (2U)
+
+/* Records of this device were dropped before this record, the batch was full */
+#define CDC_MUX_FLAG_DROPPED        (0x01U)
+
+typedef struct
+{
+    uint16_t magic;             /* CDC_MUX_MAGIC */
+    uint8_t  version;           /* CDC_MUX_VERSION */
+    uint8_t  flags;             /* Reserved, 0 */
+    uint16_t sequence;          /* Incremented per batch, a gap means frames were dropped by the sink */
+    uint16_t record_count;      /* Number of records following the header */
+} CDC_MUX_HEADER;
+
+typedef struct
+{
+    uint8_t  index;             /* emUSB-Host device index */
+    uint8_t  flags;             /* CDC_MUX_FLAG_* */
+    uint16_t length;            /* Number of data bytes following the record */
+    uint32_t timestamp_ms;      /* Time the data was read, in milliseconds since start-up */
+} CDC_MUX_RECORD;
+
+#endif /* CDC_MUX_FORMAT_H */
@@ -0,0 +1,469 @@
+/*********************************************************************************
+* File Name        :   cdc_serial_state.c
+*
+* Description      :   CDC SERIAL_STATE notifications. The device reports its
+*                      readiness on the interrupt IN endpoint and the host turns
+*                      the notifications into FreeRTOS events, so flow control
+*                      is event driven instead of polled.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "cdc_serial_state.h"
+
+/* FreeRTOS header files */
+#include "semphr.h"
+#include "timers.h"
+
+#include "app_log.h"
+#include "otg_session.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+/* Device side */
+static USB_CDC_HANDLE       serial_cdc_handle;
+static volatile bool        serial_dtr;
+static bool                 serial_ready;
+static bool                 serial_ring;
+static bool                 serial_state_valid;
+static USB_CDC_SERIAL_STATE serial_state_sent;
+static bool                 serial_state_logged;
+static StaticSemaphore_t    serial_state_mutex_buffer;
+static SemaphoreHandle_t    serial_state_mutex;
+
+/* Host side */
+static StaticEventGroup_t   serial_event_group;
+static EventGroupHandle_t   serial_events;
+
+/***********************************************************************************
+ *  Function Name: serial_state_send
+ ***********************************************************************************
+ * Summary:
+ * Sends a SERIAL_STATE notification on the interrupt IN endpoint if the state
+ * changed since the last notification. DSR is reported when the host has set
+ * DTR and the device is ready, DCD while the session is active, and the ring
+ * signal while the device requests a role swap.
+ *
+ * Parameters:
+ * log - false on the timer service task, whose stack is too small for the log
+ *       formatting. The notification is then logged by the next call with true.
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void serial_state_send(bool log)
+{
+    USB_CDC_SERIAL_STATE state;
+
+    memset(&state, 0, sizeof(state));
+    state.DCD = 1U;
+
+    xSemaphoreTake(serial_state_mutex, portMAX_DELAY);
+
+    state.DSR = (serial_dtr && serial_ready) ? 1U : 0U;
+    state.Ring = serial_ring ? 1U : 0U;
+
+    if (!serial_state_valid || (memcmp(&state, &serial_state_sent, sizeof(state)) != 0))
+    {
+        USBD_CDC_UpdateSerialState(serial_cdc_handle, &state);
+        serial_state_sent   = state;
+        serial_state_valid  = true;
+        serial_state_logged = false;
+    }
+
+    if (log && !serial_state_logged)
+    {
+        serial_state_logged = true;
+        state = serial_state_sent;
+    }
+    else
+    {
+        log = false;
+    }
+
+    xSemaphoreGive(serial_state_mutex);
+
+    if (log)
+    {
+        APP_LOG_DATA("Serial state sent: DCD=%u DSR=%u RI=%u", state.DCD, state.DSR, state.Ring);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: on_control_line_state_deferred
+ ***********************************************************************************
+ * Summary:
+ * Runs on the timer service task after the host changed DTR and reports the new
+ * DSR at once. The echo loop of the device only calls
+ * cdc_serial_state_device_update() between two reads, each of which blocks for
+ * up to APP_DELAY_TASK.
+ *
+ * Parameters:
+ * pParam  - not used
+ * param   - not used
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void on_control_line_state_deferred(void * pParam, uint32_t param)
+{
+    (void)pParam;
+    (void)param;
+
+    serial_state_send(false);
+}
+
+/***********************************************************************************
+ *  Function Name: on_control_line_state
+ ***********************************************************************************
+ * Summary:
+ * Called whenever a "SetControlLineState" packet has been received.
+ * This function is called directly from an ISR in most cases, so the
+ * notification is sent from the timer service task.
+ *
+ * Parameters:
+ * pLineState - DTR and RTS as set by the host
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void on_control_line_state(USB_CDC_CONTROL_LINE_STATE * pLineState)
+{
+    BaseType_t woken = pdFALSE;
+
+    serial_dtr = (pLineState->DTR != 0U);
+
+    if (xPortIsInsideInterrupt() != pdFALSE)
+    {
+        (void)xTimerPendFunctionCallFromISR(on_control_line_state_deferred, NULL, 0U, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        (void)xTimerPendFunctionCall(on_control_line_state_deferred, NULL, 0U, 0U);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_device_init
+ ***********************************************************************************
+ * Summary:
+ * Registers the control line state callback for the CDC instance and resets the
+ * serial state. Must be called after USBD_CDC_Add().
+ *
+ * Parameters:
+ * handle - CDC instance returned by USBD_CDC_Add()
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_device_init(USB_CDC_HANDLE handle)
+{
+    serial_cdc_handle   = handle;
+    serial_dtr          = false;
+    serial_ready        = true;
+    serial_ring         = false;
+    serial_state_valid  = false;
+    serial_state_logged = true;
+    memset(&serial_state_sent, 0, sizeof(serial_state_sent));
+
+    if (serial_state_mutex == NULL)
+    {
+        serial_state_mutex = xSemaphoreCreateMutexStatic(&serial_state_mutex_buffer);
+    }
+
+    USBD_CDC_SetOnControlLineState(handle, on_control_line_state);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_device_set_ready
+ ***********************************************************************************
+ * Summary:
+ * Sets whether the device can accept more data. The host sees the result as DSR
+ * after the next cdc_serial_state_device_update().
+ *
+ * Parameters:
+ * ready - false while the transmit path of the device is stalled
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_device_set_ready(bool ready)
+{
+    serial_ready = ready;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_device_set_ring
+ ***********************************************************************************
+ * Summary:
+ * Sets the ring signal. The device raises it to ask the host for a role swap,
+ * see otg_role.c. The host sees it after the next cdc_serial_state_device_update().
+ *
+ * Parameters:
+ * ring - true while the device requests the host role
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_device_set_ring(bool ring)
+{
+    serial_ring = ring;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_device_update
+ ***********************************************************************************
+ * Summary:
+ * Sends a SERIAL_STATE notification if the ready or ring signal changed. DTR
+ * changes of the host are reported without waiting for this call.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_device_update(void)
+{
+    serial_state_send(true);
+}
+
+/***********************************************************************************
+ *  Function Name: on_serial_state_change
+ ***********************************************************************************
+ * Summary:
+ * Called by emUSB-Host from usbh_task whenever a SERIAL_STATE notification has
+ * been received on the interrupt endpoint. Converts it into event bits. The ring
+ * signal, the request of the device for the host role, is passed on to the
+ * session at once, see otg_role.c.
+ *
+ * Parameters:
+ * pContext     - not used
+ * pSerialState - decoded notification
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void on_serial_state_change(void * pContext, USBH_CDC_SERIALSTATE * pSerialState)
+{
+    EventBits_t set = CDC_SERIAL_EVT_SEEN | CDC_SERIAL_EVT_CHANGED;
+    EventBits_t clear = 0U;
+
+    (void)pContext;
+
+    if (pSerialState->bTxCarrier != 0U)
+    {
+        set |= CDC_SERIAL_EVT_DSR;
+    }
+    else
+    {
+        clear |= CDC_SERIAL_EVT_DSR;
+    }
+
+    if (pSerialState->bRxCarrier != 0U)
+    {
+        set |= CDC_SERIAL_EVT_DCD;
+    }
+    else
+    {
+        clear |= CDC_SERIAL_EVT_DCD;
+    }
+
+    if (pSerialState->bBreak != 0U)
+    {
+        set |= CDC_SERIAL_EVT_BREAK;
+    }
+    if (pSerialState->bRingSignal != 0U)
+    {
+        set |= CDC_SERIAL_EVT_RING;
+        APP_LOG_INFO("Device requests a role swap");
+        otg_session_signal(OTG_SESSION_EVT_ROLE_SWAP);
+    }
+    if ((pSerialState->bFraming != 0U) || (pSerialState->bParity != 0U) || (pSerialState->bOverRun != 0U))
+    {
+        set |= CDC_SERIAL_EVT_ERROR;
+    }
+
+    if (clear != 0U)
+    {
+        xEventGroupClearBits(serial_events, clear);
+    }
+    xEventGroupSetBits(serial_events, set);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_host_init
+ ***********************************************************************************
+ * Summary:
+ * Creates the event group on first use and clears all event bits.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_host_init(void)
+{
+    if (serial_events == NULL)
+    {
+        serial_events = xEventGroupCreateStatic(&serial_event_group);
+    }
+    xEventGroupClearBits(serial_events, 0x00FFFFFFUL);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_host_attach
+ ***********************************************************************************
+ * Summary:
+ * Registers for SERIAL_STATE notifications of an opened CDC device and sets DTR,
+ * so the device starts reporting its readiness. The level bits are kept from a
+ * previous attach of the same device: it only notifies changes, and its state
+ * is unchanged when the host opens it again.
+ *
+ * Parameters:
+ * handle - handle returned by USBH_CDC_Open()
+ *
+ * Return:
+ * USBH_STATUS - USBH_STATUS_SUCCESS on success
+ *
+ **********************************************************************************/
+USBH_STATUS cdc_serial_state_host_attach(USBH_CDC_HANDLE handle)
+{
+    USBH_STATUS usb_status;
+
+    xEventGroupClearBits(serial_events, 0x00FFFFFFUL & ~CDC_SERIAL_EVT_LEVEL);
+
+    usb_status = USBH_CDC_SetOnSerialStateChange(handle, on_serial_state_change, NULL);
+    if (usb_status == USBH_STATUS_SUCCESS)
+    {
+        usb_status = USBH_CDC_SetDtr(handle);
+    }
+
+    return usb_status;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_host_detach
+ ***********************************************************************************
+ * Summary:
+ * Forgets the state of the removed device, so the next device starts without
+ * notifications.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_serial_state_host_detach(void)
+{
+    xEventGroupClearBits(serial_events, 0x00FFFFFFUL);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_host_wait_ready
+ ***********************************************************************************
+ * Summary:
+ * Waits until the device reports DSR. A device that sent no notification within
+ * CDC_SERIAL_STATE_FIRST_WAIT_MS of its first attach is considered ready, so
+ * devices without an interrupt endpoint still work.
+ *
+ * Parameters:
+ * timeout_ms - maximum time to wait
+ *
+ * Return:
+ * bool - true if the device is ready to receive data
+ *
+ **********************************************************************************/
+bool cdc_serial_state_host_wait_ready(uint32_t timeout_ms)
+{
+    EventBits_t bits = xEventGroupGetBits(serial_events);
+
+    if ((bits & CDC_SERIAL_EVT_SEEN) == 0U)
+    {
+        /* The first notification is sent when the device sees DTR */
+        bits = xEventGroupWaitBits(serial_events, CDC_SERIAL_EVT_SEEN, pdFALSE, pdFALSE,
+                                   pdMS_TO_TICKS(CDC_SERIAL_STATE_FIRST_WAIT_MS));
+        if ((bits & CDC_SERIAL_EVT_SEEN) == 0U)
+        {
+            return true;
+        }
+    }
+
+    if ((bits & CDC_SERIAL_EVT_DSR) != 0U)
+    {
+        return true;
+    }
+
+    bits = xEventGroupWaitBits(serial_events, CDC_SERIAL_EVT_DSR, pdFALSE, pdFALSE,
+                               pdMS_TO_TICKS(timeout_ms));
+
+    return ((bits & CDC_SERIAL_EVT_DSR) != 0U);
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_serial_state_host_events
+ ***********************************************************************************
+ * Summary:
+ * Returns the event group carrying the CDC_SERIAL_EVT_* bits.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * EventGroupHandle_t - event group, NULL before cdc_serial_state_host_init()
+ *
+ **********************************************************************************/
+EventGroupHandle_t cdc_serial_state_host_events(void)
+{
+    return serial_events;
+}
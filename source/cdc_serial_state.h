@@ -0,0 +1,111 @@
+/*********************************************************************************
+* File Name        :   cdc_serial_state.h
+*
+* Description      :   Interface for CDC SERIAL_STATE notifications on the
+*                      interrupt endpoint (device side) and their conversion into
+*                      events (host side)
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CDC_SERIAL_STATE_H
+#define CDC_SERIAL_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* emUSB-Device header file includes */
+#include "USB.h"
+#include "USB_CDC.h"
+
+/* emUSB-Host header file includes */
+#include "USBH.h"
+#include "USBH_CDC.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "event_groups.h"
+
+#include "app_config.h"
+
+/***********************************************************************************
+ *  Define configurables
+ **********************************************************************************/
+/* Interrupt endpoint polling interval in ms, rounded up (APP_INT_EP_INTERVAL is
+ * in 125 us units) */
+#define CDC_SERIAL_STATE_INTERVAL_MS    ((APP_INT_EP_INTERVAL + 7U) / 8U)
+
+/* Time the host waits for the first notification of a device before it treats
+ * the device as one without an interrupt endpoint. The device may be blocked in
+ * a read of its echo loop for APP_DELAY_TASK before it notifies, and the
+ * notification then waits for the next two polls of the endpoint. */
+#ifndef CDC_SERIAL_STATE_FIRST_WAIT_MS
+#define CDC_SERIAL_STATE_FIRST_WAIT_MS  (APP_DELAY_TASK + (2U * CDC_SERIAL_STATE_INTERVAL_MS))
+#endif
+
+/*********************************************************************
+*
+*      Host side event bits
+*
+*  The level bits mirror the last SERIAL_STATE notification. The
+*  edge bits are set on every received notification and on errors and
+*  are cleared by the consumer.
+*
+**********************************************************************/
+#define CDC_SERIAL_EVT_DSR          (1UL << 0)  /* Level: device is ready to receive (bTxCarrier) */
+#define CDC_SERIAL_EVT_DCD          (1UL << 1)  /* Level: device has an active session (bRxCarrier) */
+#define CDC_SERIAL_EVT_SEEN         (1UL << 2)  /* Level: at least one notification was received */
+#define CDC_SERIAL_EVT_CHANGED      (1UL << 3)  /* Edge: a notification was received */
+#define CDC_SERIAL_EVT_BREAK        (1UL << 4)  /* Edge: break detected */
+#define CDC_SERIAL_EVT_RING         (1UL << 5)  /* Edge: ring signal detected, the device requests a role swap */
+#define CDC_SERIAL_EVT_ERROR        (1UL << 6)  /* Edge: framing, parity or overrun error */
+
+#define CDC_SERIAL_EVT_LEVEL        (CDC_SERIAL_EVT_DSR | CDC_SERIAL_EVT_DCD | CDC_SERIAL_EVT_SEEN)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void cdc_serial_state_device_init(USB_CDC_HANDLE handle);
+void cdc_serial_state_device_set_ready(bool ready);
+void cdc_serial_state_device_set_ring(bool ring);
+void cdc_serial_state_device_update(void);
+
+void               cdc_serial_state_host_init(void);
+USBH_STATUS        cdc_serial_state_host_attach(USBH_CDC_HANDLE handle);
+void               cdc_serial_state_host_detach(void);
+bool               cdc_serial_state_host_wait_ready(uint32_t timeout_ms);
+EventGroupHandle_t cdc_serial_state_host_events(void);
+
+#endif /* CDC_SERIAL_STATE_H */
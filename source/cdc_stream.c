@@ -0,0 +1,363 @@
+/*********************************************************************************
+* File Name        :   cdc_stream.c
+*
+* Description      :   Pluggable in-place processing stage between the CDC receive
+*                      and write paths, and the cycles per byte benchmark of the
+*                      stream kernels.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "cdc_stream.h"
+
+/* Everything but the benchmark is target independent, tools/usb_replay builds
+ * this file to replay the echo with the code of the firmware */
+#if (CDC_STREAM_BENCH_ENABLE)
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_log.h"
+#include "app_timing.h"
+#endif
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+/* Built-in stages, indexed by APP_CDC_STREAM_* */
+static const cdc_stream_stage_t cdc_stream_stages[] =
+{
+    [APP_CDC_STREAM_NONE]     = { "none",     NULL,                   NULL                   },
+    [APP_CDC_STREAM_BSWAP32]  = { "bswap32",  stream_bswap32,         stream_bswap32         },
+    [APP_CDC_STREAM_CHECKSUM] = { "checksum", stream_checksum_append, stream_checksum_verify },
+    [APP_CDC_STREAM_SLIP]     = { "slip",     stream_slip_encode,     stream_slip_decode     },
+    [APP_CDC_STREAM_COBS]     = { "cobs",     stream_cobs_encode,     stream_cobs_decode     },
+};
+
+_Static_assert(APP_CDC_STREAM < (sizeof(cdc_stream_stages) / sizeof(cdc_stream_stages[0])),
+               "APP_CDC_STREAM selects an unknown stage");
+
+static const cdc_stream_stage_t* volatile cdc_stream_stage = &cdc_stream_stages[APP_CDC_STREAM];
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_set_stage
+ ***********************************************************************************
+ * Summary:
+ * Replaces the processing stage selected with APP_CDC_STREAM, for example with
+ * an application specific transform. The kernels of the stage must follow the
+ * rules in stream_kernels.h, and the encoder must produce at most
+ * APP_CDC_STREAM_BUFFER_SIZE(n) bytes for n bytes of input. Data that does not
+ * fit is dropped by the kernel (result 0), and the echo logs and counts it.
+ *
+ * Parameters:
+ * stage - new stage, NULL passes the data unchanged
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_stream_set_stage(const cdc_stream_stage_t* stage)
+{
+    cdc_stream_stage = (stage != NULL) ? stage : &cdc_stream_stages[APP_CDC_STREAM_NONE];
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_get_stage
+ ***********************************************************************************
+ * Summary:
+ * Returns the active processing stage.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * const cdc_stream_stage_t* - active stage
+ *
+ **********************************************************************************/
+const cdc_stream_stage_t* cdc_stream_get_stage(void)
+{
+    return cdc_stream_stage;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_find_stage
+ ***********************************************************************************
+ * Summary:
+ * Looks up a built-in stage by name.
+ *
+ * Parameters:
+ * name - name of the stage, for example "cobs"
+ *
+ * Return:
+ * const cdc_stream_stage_t* - stage, NULL if there is no stage of that name
+ *
+ **********************************************************************************/
+const cdc_stream_stage_t* cdc_stream_find_stage(const char* name)
+{
+    for (size_t i = 0U; i < (sizeof(cdc_stream_stages) / sizeof(cdc_stream_stages[0])); i++)
+    {
+        if (strcmp(cdc_stream_stages[i].name, name) == 0)
+        {
+            return &cdc_stream_stages[i];
+        }
+    }
+
+    return NULL;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_encode
+ ***********************************************************************************
+ * Summary:
+ * Applies the encoder of the active stage to received data, in place.
+ *
+ * Parameters:
+ * data   - received data
+ * length - number of received bytes
+ * size   - capacity of data, see APP_CDC_STREAM_BUFFER_SIZE()
+ *
+ * Return:
+ * uint32_t - number of bytes to send, 0 if the data could not be processed
+ *
+ **********************************************************************************/
+uint32_t cdc_stream_encode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    stream_kernel_t encode = cdc_stream_stage->encode;
+
+    return (encode != NULL) ? encode(data, length, size) : length;
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_decode
+ ***********************************************************************************
+ * Summary:
+ * Applies the decoder of the active stage to received data, in place.
+ *
+ * Parameters:
+ * data   - received data
+ * length - number of received bytes
+ * size   - capacity of data
+ *
+ * Return:
+ * uint32_t - number of decoded bytes, 0 if the data is invalid
+ *
+ **********************************************************************************/
+uint32_t cdc_stream_decode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    stream_kernel_t decode = cdc_stream_stage->decode;
+
+    return (decode != NULL) ? decode(data, length, size) : length;
+}
+
+#if (CDC_STREAM_BENCH_ENABLE)
+
+#define CDC_STREAM_BENCH_RUNS       (16U)
+
+typedef struct
+{
+    const char*     name;
+    stream_kernel_t fast;
+    stream_kernel_t scalar;     /* NULL if there is no byte-at-a-time reference */
+    stream_kernel_t prepare;    /* Encoder that produces the input of a decoder, NULL for encoders */
+} cdc_stream_bench_t;
+
+static const cdc_stream_bench_t cdc_stream_bench[] =
+{
+    { "bswap32",  stream_bswap32,         stream_bswap32_scalar,         NULL                   },
+    { "checksum", stream_checksum_append, stream_checksum_append_scalar, NULL                   },
+    { "slip",     stream_slip_encode,     stream_slip_encode_scalar,     NULL                   },
+    { "cobs",     stream_cobs_encode,     stream_cobs_encode_scalar,     NULL                   },
+    { "verify",   stream_checksum_verify, stream_checksum_verify_scalar, stream_checksum_append },
+    { "unslip",   stream_slip_decode,     stream_slip_decode_scalar,     stream_slip_encode     },
+    { "uncobs",   stream_cobs_decode,     NULL,                          stream_cobs_encode     },
+};
+
+static uint8_t bench_input[STREAM_SLIP_MAX_SIZE(CDC_STREAM_BENCH_SIZE)];
+static uint8_t bench_fast[STREAM_SLIP_MAX_SIZE(CDC_STREAM_BENCH_SIZE)];
+static uint8_t bench_scalar[STREAM_SLIP_MAX_SIZE(CDC_STREAM_BENCH_SIZE)];
+
+/***********************************************************************************
+ *  Function Name: bench_run
+ ***********************************************************************************
+ * Summary:
+ * Runs a kernel on a copy of the benchmark input and returns the best case
+ * number of cycles of CDC_STREAM_BENCH_RUNS runs. Interrupts are disabled
+ * during each run.
+ *
+ * Parameters:
+ * kernel - kernel to measure
+ * input  - number of input bytes in bench_input
+ * buffer - work buffer, holds the result afterwards
+ * length - returns the output length of the kernel
+ *
+ * Return:
+ * uint32_t - cycles
+ *
+ **********************************************************************************/
+static uint32_t bench_run(stream_kernel_t kernel, uint32_t input, uint8_t* buffer, uint32_t* length)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t run = 0U; run < CDC_STREAM_BENCH_RUNS; run++)
+    {
+        uint32_t start;
+        uint32_t cycles;
+
+        memcpy(buffer, bench_input, input);
+
+        taskENTER_CRITICAL();
+        start   = app_timing_now();
+        *length = kernel(buffer, input, sizeof(bench_input));
+        cycles  = app_timing_now() - start;
+        taskEXIT_CRITICAL();
+
+        if (cycles < best)
+        {
+            best = cycles;
+        }
+    }
+
+    return best;
+}
+
+/***********************************************************************************
+ *  Function Name: bench_fill
+ ***********************************************************************************
+ * Summary:
+ * Fills bench_input with pseudo-random data with a special character (0x00,
+ * 0xC0 or 0xDB) about every 32 bytes, so the framing kernels take both paths.
+ * The sequence is the same on every call.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void bench_fill(void)
+{
+    static const uint8_t specials[] = { 0x00U, STREAM_SLIP_END, STREAM_SLIP_ESC };
+    uint32_t seed = 0x12345678U;
+
+    for (uint32_t i = 0U; i < CDC_STREAM_BENCH_SIZE; i++)
+    {
+        seed = (seed * 1664525U) + 1013904223U;
+        bench_input[i] = ((seed >> 27) == 0U) ? specials[(seed >> 8) % sizeof(specials)]
+                                              : (uint8_t)((seed >> 16) | 0x01U);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: cdc_stream_benchmark
+ ***********************************************************************************
+ * Summary:
+ * Measures the cycles per byte of every word-at-a-time kernel and of its scalar
+ * reference, encoders and decoders, checks that both produce the same output,
+ * and logs the results. A decoder runs on the output of its encoder; the cycles
+ * are given per byte of the original data, so encoders and decoders compare.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void cdc_stream_benchmark(void)
+{
+    app_timing_init();
+
+    APP_LOG_INFO("Stream kernels, %u bytes, cycles per byte (word / scalar):",
+                 (unsigned int)CDC_STREAM_BENCH_SIZE);
+
+    for (uint32_t k = 0U; k < (sizeof(cdc_stream_bench) / sizeof(cdc_stream_bench[0])); k++)
+    {
+        const cdc_stream_bench_t* bench = &cdc_stream_bench[k];
+        uint32_t input = CDC_STREAM_BENCH_SIZE;
+        uint32_t fast_length;
+        uint32_t scalar_length;
+        uint32_t fast;
+        uint32_t scalar;
+
+        bench_fill();
+        if (bench->prepare != NULL)
+        {
+            input = bench->prepare(bench_input, CDC_STREAM_BENCH_SIZE, sizeof(bench_input));
+        }
+
+        /* Hundredths of a cycle per byte */
+        fast = bench_run(bench->fast, input, bench_fast, &fast_length);
+        fast = (fast * 100U) / CDC_STREAM_BENCH_SIZE;
+
+        if (bench->scalar == NULL)
+        {
+            APP_LOG_INFO("  %-8s %lu.%02lu", bench->name,
+                         (unsigned long)(fast / 100U), (unsigned long)(fast % 100U));
+        }
+        else
+        {
+            scalar = bench_run(bench->scalar, input, bench_scalar, &scalar_length);
+            scalar = (scalar * 100U) / CDC_STREAM_BENCH_SIZE;
+
+            APP_LOG_INFO("  %-8s %lu.%02lu / %lu.%02lu", bench->name,
+                         (unsigned long)(fast / 100U), (unsigned long)(fast % 100U),
+                         (unsigned long)(scalar / 100U), (unsigned long)(scalar % 100U));
+
+            if ((fast_length != scalar_length) || (memcmp(bench_fast, bench_scalar, fast_length) != 0))
+            {
+                APP_LOG_ERROR("  %s: word and scalar results differ", bench->name);
+            }
+        }
+
+        /* A decoder must restore the original data */
+        if (bench->prepare != NULL)
+        {
+            bench_fill();
+            if ((fast_length != CDC_STREAM_BENCH_SIZE) || (memcmp(bench_fast, bench_input, fast_length) != 0))
+            {
+                APP_LOG_ERROR("  %s: decoded data differs from the input", bench->name);
+            }
+        }
+    }
+}
+
+#endif /* CDC_STREAM_BENCH_ENABLE */
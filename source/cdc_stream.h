@@ -0,0 +1,84 @@
+/*********************************************************************************
+* File Name        :   cdc_stream.h
+*
+* Description      :   Interface of the pluggable CDC stream processing stage
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CDC_STREAM_H
+#define CDC_STREAM_H
+
+#include <stdint.h>
+
+#include "stream_kernels.h"
+
+/***********************************************************************************
+ *  Define configurables
+ **********************************************************************************/
+/* Set CDC_STREAM_BENCH_ENABLE=1 in the Makefile DEFINES to benchmark the kernels at startup */
+#ifndef CDC_STREAM_BENCH_ENABLE
+#define CDC_STREAM_BENCH_ENABLE     (0)
+#endif
+
+/* Number of bytes processed per benchmark run */
+#ifndef CDC_STREAM_BENCH_SIZE
+#define CDC_STREAM_BENCH_SIZE       (512U)
+#endif
+
+/* A processing stage. A NULL kernel passes the data unchanged. */
+typedef struct
+{
+    const char*     name;
+    stream_kernel_t encode;     /* Device: applied to received data before the echo */
+    stream_kernel_t decode;     /* Host: applied to the echo read back from the device */
+} cdc_stream_stage_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void                      cdc_stream_set_stage(const cdc_stream_stage_t* stage);
+const cdc_stream_stage_t* cdc_stream_get_stage(void);
+const cdc_stream_stage_t* cdc_stream_find_stage(const char* name);
+uint32_t                  cdc_stream_encode(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t                  cdc_stream_decode(uint8_t* data, uint32_t length, uint32_t size);
+
+#if (CDC_STREAM_BENCH_ENABLE)
+void cdc_stream_benchmark(void);
+#else
+#define cdc_stream_benchmark()      do { } while (0)
+#endif /* CDC_STREAM_BENCH_ENABLE */
+
+#endif /* CDC_STREAM_H */
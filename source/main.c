@@ -45,7 +45,10 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
-#define MAIN_TASK_STACK_SIZE                    (512U)
+#include "app_config.h"
+#include "usb_suspend.h"
+
+#define MAIN_TASK_STACK_SIZE                    (APP_MAIN_TASK_STACK_SIZE)
 
 void main_task(void* arg);
 
@@ -67,7 +70,7 @@ int main(void)
     __enable_irq();
 
     rtos_task_status = xTaskCreate(main_task, "main_task", MAIN_TASK_STACK_SIZE, NULL,
-                                   configMAX_PRIORITIES - 1, NULL);
+                                   APP_PRIO_MAIN_TASK, NULL);
     
     if (rtos_task_status != pdPASS)
     {
@@ -81,3 +84,25 @@ int main(void)
 
     }
 }
+
+/***********************************************************************************
+ *  Function Name: vApplicationIdleHook
+ ***********************************************************************************
+ * Summary:
+ * FreeRTOS idle hook. Halts the core until the next interrupt while the USB bus
+ * is suspended.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void vApplicationIdleHook(void)
+{
+    if (usb_suspend_is_active())
+    {
+        __WFI();
+    }
+}
@@ -58,16 +58,31 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "app_config.h"
+#include "app_log.h"
+#include "app_metrics.h"
+#include "cdc_host_rto.h"
+#include "cdc_mux.h"
+#include "cdc_serial_state.h"
+#include "cdc_stream.h"
+#include "otg_role.h"
+#include "otg_session.h"
+#include "usb_latency.h"
+#include "usb_pool.h"
+#include "usb_suspend.h"
+#include "usb_trace.h"
+
 /***********************************************************************************
  *  Define configurables
  **********************************************************************************/
-#define DELAY_TASK                  (100U)
-#define USB_CONFIG_DELAY            (50U)
+/* Timing, buffer sizes and task settings are derived from the build profile, see app_config.h */
+#define DELAY_TASK                  (APP_DELAY_TASK)
+#define USB_CONFIG_DELAY            (APP_USB_CONFIG_DELAY)
 #define DELAY_ECHO_COMMUNICATION    (5000U)
 
 /* Size for tasks stack */
-#define USB_MAIN_TASK_MEMORY_REQ    (500U)
-#define USB_ISR_TASK_MEMORY_REQ     (500U)
+#define USB_MAIN_TASK_MEMORY_REQ    (APP_USBH_TASK_STACK_SIZE)
+#define USB_ISR_TASK_MEMORY_REQ     (APP_USBH_ISR_TASK_STACK_SIZE)
 
 /*********************************************************************
 *
@@ -75,10 +90,15 @@
 *
 **********************************************************************/
 static USB_CDC_HANDLE usb_cdcHandle;
-static char        temp_buffer[USB_FS_BULK_MAX_PACKET_SIZE];
+/* Room for the output of any stream processing stage, since the stage can be
+ * replaced at runtime, plus one byte that keeps the buffer NUL-terminated for
+ * logging */
+static char        temp_buffer[APP_CDC_STREAM_BUFFER_SIZE(APP_CDC_RX_BUFFER_SIZE) + 1U];
 
 static bool cdc_line_coding_is_updated = false;
 static USB_CDC_LINE_CODING cdc_line_coding;
+static USB_HOOK            usb_state_hook;
+static volatile bool       usb_attached;
 
 /* Information that is used during enumeration. */
 static const USB_DEVICE_INFO usb_deviceInfo = {
@@ -99,19 +119,29 @@ static USBH_NOTIFICATION_HOOK usbh_cdc_notification;
 static volatile char       device_ready;
 static I8                  device_index;
 static uint8_t             data_buffer[64U];
+static UBaseType_t         host_num_tasks;
+static bool                usb_pool_locked;
 
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
+static int  otg_detect(void);
+static void device_start(void);
 static void device_app(void);
+static void device_stop(void);
+static void host_start(void);
 static void host_app(void);
+static bool host_stop(void);
+static bool host_grant_swap(void);
 
 
 /***********************************************************************************
  *  Function Name: main_task
  ***********************************************************************************
  * Summary:
- * Select Host or Device mode based on connection
+ * Runs the OTG session state machine: detects the Host or Device role based on
+ * the connection, runs the session, and tears it down when the cable or the
+ * device is removed. See otg_session.c.
  *
  * Parameters:
  * arg - is not used in this function, is required by FreeRTOS
@@ -123,7 +153,7 @@ static void host_app(void);
 void main_task(void * arg)
 {
     (void) arg;
-    int otg_state;
+    int otg_state = USB_OTG_ID_PIN_STATE_IS_INVALID;
 
     cy_rslt_t result;
     
@@ -142,50 +172,144 @@ void main_task(void * arg)
         " XMC MCU: USB OTG application "
         "******************\r\n\n");
 
+    /* From here on, log messages are printed by log_task */
+    app_log_init();
+    usb_trace_init();
+    otg_session_init();
+    cdc_stream_benchmark();
+    APP_LOG_INFO("CDC stream stage: %s", cdc_stream_get_stage()->name);
+
     for (;;)
     {
-        USB_OTG_Init();
-        USBH_Logf_Application("OTG detection started");
-
-        for (;;)
+        switch (otg_session_get_state())
         {
-            otg_state = USB_OTG_GetSessionState();
+            case OTG_SESSION_STATE_DETECT:
+                /* A role swap overrides the ID pin for one session, see otg_role.c */
+                otg_state = otg_role_select();
+                if (otg_state == USB_OTG_ID_PIN_STATE_IS_INVALID)
+                {
+                    otg_state = otg_detect();
+                }
+
+                if (otg_state == USB_OTG_ID_PIN_STATE_IS_HOST)
+                {
+                    APP_LOG_INFO("Host session detected");
+                    USB_TRACE(USB_TRACE_EVT_SESSION_HOST, 0U, 0, NULL, 0U);
+                    otg_session_enter(OTG_SESSION_STATE_HOST_ACTIVE);
+                    host_start();
+                }
+                else if (otg_state == USB_OTG_ID_PIN_STATE_IS_DEVICE)
+                {
+                    APP_LOG_INFO("Device session detected");
+                    USB_TRACE(USB_TRACE_EVT_SESSION_DEVICE, 0U, 0, NULL, 0U);
+                    otg_session_enter(OTG_SESSION_STATE_DEVICE_ACTIVE);
+                    device_start();
+                }
+                else
+                {
+                    /* Do nothing. Under normal circumstances, the application shall never go to this condition */
+                    APP_LOG_ERROR("Error! Incorrect state. Stop execution");
+                    for (;;);
+                }
+                break;
 
-            if (otg_state != USB_OTG_ID_PIN_STATE_IS_INVALID)
-            {
+            case OTG_SESSION_STATE_HOST_ACTIVE:
+                host_app();
+                otg_session_enter(OTG_SESSION_STATE_TEARDOWN);
                 break;
-            }
-            else
-            {
-                XMC_Delay(USB_CONFIG_DELAY);
-                XMC_GPIO_SetOutputHigh(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+
+            case OTG_SESSION_STATE_DEVICE_ACTIVE:
+                device_app();
+                otg_session_enter(OTG_SESSION_STATE_TEARDOWN);
+                break;
+
+            case OTG_SESSION_STATE_TEARDOWN:
+            default:
+                USB_TRACE(USB_TRACE_EVT_SESSION_END, 0U, 0, NULL, 0U);
+
+                if (otg_state == USB_OTG_ID_PIN_STATE_IS_HOST)
+                {
+                    if (!host_stop())
+                    {
+                        /* Tasks may still run on their pool stacks, never reuse the pool */
+                        usb_pool_locked = true;
+                    }
+                }
+                else
+                {
+                    device_stop();
+                }
+
+                /* The USB stack is shut down, release the memory of the session */
+                usb_pool_report();
+                if (!usb_pool_locked)
+                {
+                    usb_pool_reset();
+                }
+                otg_role_report();
+                otg_session_enter(OTG_SESSION_STATE_DETECT);
+
+                usb_trace_dump();
                 XMC_Delay(USB_CONFIG_DELAY);
-                XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
-            }
+                break;
         }
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: otg_detect
+ ***********************************************************************************
+ * Summary:
+ * Runs the USB OTG driver until the ID pin selects the host or device role.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * int - USB_OTG_ID_PIN_STATE_IS_HOST or USB_OTG_ID_PIN_STATE_IS_DEVICE
+ *
+ **********************************************************************************/
+static int otg_detect(void)
+{
+    int        otg_state;
+#if (APP_OTG_SRP_INTERVAL_MS != 0U)
+    TickType_t srp_tick = xTaskGetTickCount();
+#endif
 
-        USB_OTG_DeInit();
-        XMC_Delay(USB_CONFIG_DELAY);
+    USB_OTG_Init();
+    APP_LOG_INFO("OTG detection started");
 
-        if (otg_state == USB_OTG_ID_PIN_STATE_IS_HOST)
-        {
-            USBH_Logf_Application("Host session detected");
-            host_app();
-        }
-        else if (otg_state == USB_OTG_ID_PIN_STATE_IS_DEVICE)
+    for (;;)
+    {
+        otg_state = USB_OTG_GetSessionState();
+
+        if (otg_state != USB_OTG_ID_PIN_STATE_IS_INVALID)
         {
-            USBH_Logf_Application("Device session detected");
-            device_app();
+            break;
         }
         else
         {
-            /* Do nothing. Under normal circumstances, the application shall never go to this condition */
-            USBH_Logf_Application("Error! Incorrect state. Stop execution");
-            for (;;);
-        }
+#if (APP_OTG_SRP_INTERVAL_MS != 0U)
+            /* B-device without VBUS: ask the A-device to start a session */
+            if ((USB_OTG_GetIdPin() != 0) &&
+                (((uint32_t)(xTaskGetTickCount() - srp_tick) * portTICK_PERIOD_MS) >= APP_OTG_SRP_INTERVAL_MS))
+            {
+                (void)otg_role_request_session();
+                srp_tick = xTaskGetTickCount();
+            }
+#endif
 
-        XMC_Delay(USB_CONFIG_DELAY);
+            XMC_Delay(USB_CONFIG_DELAY);
+            XMC_GPIO_SetOutputHigh(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+            XMC_Delay(USB_CONFIG_DELAY);
+            XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+        }
     }
+
+    USB_OTG_DeInit();
+    XMC_Delay(USB_CONFIG_DELAY);
+
+    return otg_state;
 }
 
 /*********************************************************************
@@ -194,6 +318,9 @@ void main_task(void * arg)
 * Summary:
 *  Called whenever a "SetLineCoding" Packet has been received.
 *  This function is called directly from an ISR in most cases.
+*  APP_OTG_HNP_ENABLE_RATE is not a line coding but the grant of a
+*  role swap, see otg_role.c. It is taken as such from any host,
+*  including a terminal program set to that baud rate.
 *
 * Parameters:
 *  pLineCoding
@@ -203,6 +330,12 @@ void main_task(void * arg)
 **********************************************************************/
 static void on_line_coding(USB_CDC_LINE_CODING * pLineCoding)
 {
+    if (pLineCoding->DTERate == APP_OTG_HNP_ENABLE_RATE)
+    {
+        otg_role_hnp_enable_from_isr();
+        return;
+    }
+
     cdc_line_coding.DTERate     = pLineCoding->DTERate;
     cdc_line_coding.CharFormat  = pLineCoding->CharFormat;
     cdc_line_coding.ParityType  = pLineCoding->ParityType;
@@ -211,6 +344,46 @@ static void on_line_coding(USB_CDC_LINE_CODING * pLineCoding)
     cdc_line_coding_is_updated = true;
 }
 
+/*********************************************************************
+* Function Name: on_device_state
+**********************************************************************
+* Summary:
+*  Called whenever the device state changes.
+*  This function is called directly from an ISR in most cases.
+*  Passes suspend and resume on to usb_suspend.c and signals the
+*  detach event when VBUS or the host is lost.
+*
+* Parameters:
+*  pContext - not used
+*  NewState - new USB_STAT_* state of the device
+*
+* Return:
+*  void
+**********************************************************************/
+static void on_device_state(void * pContext, U8 NewState)
+{
+    (void)pContext;
+
+    usb_suspend_on_state_change(NewState);
+
+    if ((NewState & USB_STAT_ATTACHED) != 0U)
+    {
+        usb_attached = true;
+    }
+    else if (usb_attached)
+    {
+        usb_attached = false;
+        if (xPortIsInsideInterrupt() != pdFALSE)
+        {
+            otg_session_signal_from_isr(OTG_SESSION_EVT_DETACH);
+        }
+        else
+        {
+            otg_session_signal(OTG_SESSION_EVT_DETACH);
+        }
+    }
+}
+
 /*********************************************************************
 * Function Name: usb_add_cdc
 **********************************************************************
@@ -225,7 +398,8 @@ static void on_line_coding(USB_CDC_LINE_CODING * pLineCoding)
 **********************************************************************/
 static void usb_add_cdc(void)
 {
-    static uint8_t OutBuffer[USB_FS_BULK_MAX_PACKET_SIZE];
+    const uint32_t        OutBufferSize = USB_FS_BULK_MAX_PACKET_SIZE * APP_CDC_OUT_BUFFER_PACKETS;
+    uint8_t*              OutBuffer = usb_pool_alloc(OutBufferSize);
     USB_CDC_INIT_DATA     InitData;
     USB_ADD_EP_INFO       EPBulkIn;
     USB_ADD_EP_INFO       EPBulkOut;
@@ -244,26 +418,83 @@ static void usb_add_cdc(void)
     EPBulkOut.Interval      = 0;                             /* Interval not used for Bulk endpoints */
     EPBulkOut.MaxPacketSize = USB_FS_BULK_MAX_PACKET_SIZE;   /* Maximum packet size (64B for Bulk in full-speed) */
     EPBulkOut.TransferType  = USB_TRANSFER_TYPE_BULK;        /* Endpoint type - Bulk */
-    InitData.EPOut = USBD_AddEPEx(&EPBulkOut, OutBuffer, sizeof(OutBuffer));
+    CY_ASSERT(OutBuffer != NULL);
+    InitData.EPOut = USBD_AddEPEx(&EPBulkOut, OutBuffer, OutBufferSize);
 
     EPIntIn.Flags           = 0;                             /* Flags not used */
     EPIntIn.InDir           = USB_DIR_IN;                    /* IN direction (Device to Host) */
-    EPIntIn.Interval        = 64;                            /* Interval of 8 ms (64 * 125us) */
+    EPIntIn.Interval        = APP_INT_EP_INTERVAL;           /* Interval in 125us units (64 = 8 ms) */
     EPIntIn.MaxPacketSize   = USB_FS_INT_MAX_PACKET_SIZE ;   /* Maximum packet size (64 for Interrupt) */
     EPIntIn.TransferType    = USB_TRANSFER_TYPE_INT;         /* Endpoint type - Interrupt */
     InitData.EPInt = USBD_AddEPEx(&EPIntIn, NULL, 0);
 
     usb_cdcHandle = USBD_CDC_Add(&InitData);
     USBD_CDC_SetOnLineCoding(usb_cdcHandle, on_line_coding);
+    cdc_serial_state_device_init(usb_cdcHandle);
 }
 
 /***********************************************************************************
- *  Function Name: device_app
+ *  Function Name: cdc_echo_write
+ ***********************************************************************************
+ * Summary:
+ * Sends data back to the host. If the host does not read the data within
+ * APP_CDC_TX_STALL_TIMEOUT, DSR is dropped through a SERIAL_STATE notification
+ * so the host pauses sending, and raised again once the data is out or the
+ * device is detached.
+ *
+ * Parameters:
+ * data   - data to send
+ * length - number of bytes to send
+ *
+ * Return:
+ * int - number of bytes sent, or a negative emUSB-Device error code
+ *
+ **********************************************************************************/
+static int cdc_echo_write(const char* data, int length)
+{
+    int num_bytes_sent = USBD_CDC_Write(usb_cdcHandle, data, length, APP_CDC_TX_STALL_TIMEOUT);
+
+    if (num_bytes_sent < 0)
+    {
+        num_bytes_sent = 0;
+    }
+
+    if (num_bytes_sent < length)
+    {
+        /* Transmit path is stalled, tell the host to stop sending */
+        app_metrics_inc(APP_METRIC_DEVICE_TX_STALLS);
+        cdc_serial_state_device_set_ready(false);
+        cdc_serial_state_device_update();
+
+        /* Retry in bounded steps so a detach cancels the transfer */
+        while ((num_bytes_sent < length) && !otg_session_pending(OTG_SESSION_EVT_DETACH))
+        {
+            int result = USBD_CDC_Write(usb_cdcHandle, &data[num_bytes_sent], length - num_bytes_sent,
+                                        APP_CDC_TX_STALL_TIMEOUT);
+
+            if ((result < 0) && (result != USB_STATUS_TIMEOUT))
+            {
+                num_bytes_sent = result;
+                break;
+            }
+            else if (result > 0)
+            {
+                num_bytes_sent += result;
+            }
+        }
+
+        cdc_serial_state_device_set_ready(true);
+        cdc_serial_state_device_update();
+    }
+
+    return num_bytes_sent;
+}
+
+/***********************************************************************************
+ *  Function Name: device_start
  ***********************************************************************************
  * Summary:
- * Configures the CDC device, waits for enumeration, and echoes all received data.
- * As soon as a disconnection event occurs, the function deinitializes emUSB-Device
- * and returns.
+ * Initializes emUSB-Device with the CDC class and connects to the host.
  *
  * Parameters:
  * None
@@ -272,78 +503,218 @@ static void usb_add_cdc(void)
  * void
  *
  **********************************************************************************/
-static void device_app(void)
+static void device_start(void)
 {
-    int  num_bytes_received;
-
     /* Initializes the USB stack */
     USBD_Init();
 
     /* Endpoint Initialization for CDC class */
     usb_add_cdc();
 
+    /* Answer metrics queries on a vendor specific interface of their own */
+    app_metrics_device_init();
+
     /* Set device info used in enumeration */
     USBD_SetDeviceInfo(&usb_deviceInfo);
 
+    /* Keep the session across bus suspend */
+    usb_suspend_init();
+
+    /* Deliver suspend, resume and detach events to the session */
+    usb_attached = false;
+    USBD_RegisterSCHook(&usb_state_hook, on_device_state, NULL);
+
     /* Start the USB stack */
     USBD_Start();
 
-    USBH_Logf_Application("emUSB-Device is initialized");
+    APP_LOG_INFO("emUSB-Device is initialized");
+}
+
+/***********************************************************************************
+ *  Function Name: device_app
+ ***********************************************************************************
+ * Summary:
+ * Waits for enumeration and echoes all received data. While the bus is
+ * suspended, the session is kept and the task sleeps until the host resumes.
+ * As soon as a disconnection event occurs, the function returns.
+ *
+ * Parameters:
+ * None
+ * 
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void device_app(void)
+{
+    int  num_bytes_received;
+    int  last_dev_state = -1;
 
     /* Wait for configuration */
     while ((USBD_GetState() & (USB_STAT_CONFIGURED | USB_STAT_SUSPENDED)) != USB_STAT_CONFIGURED)
     {
         XMC_GPIO_ToggleOutput(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
-        XMC_Delay(USB_CONFIG_DELAY);
+
+        if (otg_session_wait(OTG_SESSION_EVT_DETACH, USB_CONFIG_DELAY) != 0U)
+        {
+            APP_LOG_INFO("Device is disconnected");
+            return;
+        }
+
+        /* After a role swap, the new host must enumerate the device in time */
+        if (otg_role_swapped() && !otg_role_swap_pending())
+        {
+            return;
+        }
     }
 
-    USBH_Logf_Application("Device enumerated");
-    USBH_Logf_Application("Please open another serial monitor for USB CDC Device");
-    USBH_Logf_Application("Send any message to device and be sure that you receive it back.");
+    otg_session_ready();
+    otg_role_ready();
+    app_metrics_inc(APP_METRIC_DEVICE_ENUMERATIONS);
+    APP_LOG_INFO("Device enumerated");
+
+    APP_LOG_INFO("Please open another serial monitor for USB CDC Device");
+    APP_LOG_INFO("Send any message to device and be sure that you receive it back.");
 
     for(;;)
     {
         int dev_state = USBD_GetState();
 
+        if (dev_state != last_dev_state)
+        {
+            USB_TRACE(USB_TRACE_EVT_USBD_STATE, 0U, dev_state, NULL, 0U);
+            last_dev_state = dev_state;
+        }
+
+        /* Suspend: keep the CDC session, sleep until the host resumes the bus */
+        if (((dev_state & USB_STAT_CONFIGURED) != 0U) && ((dev_state & USB_STAT_SUSPENDED) != 0U))
+        {
+            XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+
+            if (usb_suspend_wait_resume(APP_USB_SUSPEND_TIMEOUT_MS))
+            {
+                continue;
+            }
+            dev_state = USBD_GetState();
+        }
+
         /* Check disconnection event */
-        if (((dev_state & USB_STAT_CONFIGURED) == 0U || (dev_state & USB_STAT_SUSPENDED) != 0U))
+        if (((dev_state & USB_STAT_CONFIGURED) == 0U) || ((dev_state & USB_STAT_SUSPENDED) != 0U) ||
+            otg_session_pending(OTG_SESSION_EVT_DETACH))
+        {
+            XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+            APP_LOG_INFO("Device is disconnected");
+            break;
+        }
+
+        /* Stress test: detach from the host to start the next cycle */
+        if (otg_session_stress_due())
         {
             XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
-            USBH_Logf_Application("Device is disconnected");
             break;
         }
 
+        /* The host granted a role swap: disconnect, the next session runs as host */
+        if (otg_session_pending(OTG_SESSION_EVT_ROLE_SWAP))
+        {
+            XMC_GPIO_SetOutputLow(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
+            APP_LOG_INFO("Role swap granted by the host");
+            break;
+        }
+
+        if (otg_role_swap_due())
+        {
+            otg_role_request_swap();
+        }
+
         XMC_GPIO_SetOutputHigh(CYBSP_USER_LED1_PORT, CYBSP_USER_LED1_PIN);
 
         if (cdc_line_coding_is_updated)
         {
             cdc_line_coding_is_updated = false;
-            USBH_Logf_Application("DTERate=%lu, CharFormat=%u, ParityType=%u, DataBits=%u\n",
-                                    cdc_line_coding.DTERate, cdc_line_coding.CharFormat,
-                                    cdc_line_coding.ParityType, cdc_line_coding.DataBits);
+            APP_LOG_INFO("DTERate=%lu, CharFormat=%u, ParityType=%u, DataBits=%u\n",
+                           cdc_line_coding.DTERate, cdc_line_coding.CharFormat,
+                           cdc_line_coding.ParityType, cdc_line_coding.DataBits);
         }
 
-        memset (temp_buffer, 0, sizeof(temp_buffer));
+        /* Report DTR/DSR changes and role swap requests on the interrupt endpoint */
+        cdc_serial_state_device_set_ring(otg_role_host_requested());
+        cdc_serial_state_device_update();
 
-        /* Receive one USB data packet and echo it back. */
-        num_bytes_received = USBD_CDC_Receive(usb_cdcHandle, &temp_buffer[0], sizeof(temp_buffer), 0);
-        
-        USBH_Logf_Application("CDC data received from Host: %s", (char*) temp_buffer);
+        /* Receive one USB data packet and echo it back. The timeout lets the
+         * loop service state changes while the host is not sending. */
+        num_bytes_received = USBD_CDC_Receive(usb_cdcHandle, &temp_buffer[0], APP_CDC_RX_BUFFER_SIZE, DELAY_TASK);
 
         if (num_bytes_received > 0)
         {
-            USBD_CDC_Write(usb_cdcHandle, &temp_buffer[0], num_bytes_received, 0);
+            temp_buffer[num_bytes_received] = '\0';
+            usb_suspend_on_data();
+            app_metrics_inc(APP_METRIC_DEVICE_RX_PACKETS);
+            app_metrics_add(APP_METRIC_DEVICE_RX_BYTES, (uint32_t)num_bytes_received);
+            USB_TRACE(USB_TRACE_EVT_USBD_CDC_RECEIVE, usb_cdcHandle, num_bytes_received,
+                      temp_buffer, num_bytes_received);
+            APP_LOG_DATA("CDC data received from Host: %s", (char*) temp_buffer);
+
+            /* Transform the data in place before the echo, see cdc_stream.c */
+            uint32_t num_bytes_echo = cdc_stream_encode((uint8_t*)temp_buffer, (uint32_t)num_bytes_received,
+                                                        sizeof(temp_buffer) - 1U);
+            temp_buffer[num_bytes_echo] = '\0';
+
+            if (num_bytes_echo == 0U)
+            {
+                /* The output of the stage does not fit into temp_buffer */
+                app_metrics_inc(APP_METRIC_DEVICE_ECHO_DROPPED);
+                APP_LOG_ERROR("Echo of %d bytes dropped (%s stage)", num_bytes_received,
+                              cdc_stream_get_stage()->name);
+            }
+            else
+            {
+                int num_bytes_sent = cdc_echo_write(&temp_buffer[0], (int)num_bytes_echo);
+                if (num_bytes_sent > 0)
+                {
+                    app_metrics_add(APP_METRIC_DEVICE_ECHO_BYTES, (uint32_t)num_bytes_sent);
+                }
+                USB_TRACE(USB_TRACE_EVT_USBD_CDC_WRITE, usb_cdcHandle, num_bytes_sent,
+                          temp_buffer, num_bytes_echo);
+                APP_LOG_DATA("CDC data sent to Host: %s", (char*) temp_buffer);
+            }
+        }
+        else if ((num_bytes_received < 0) && (num_bytes_received != USB_STATUS_TIMEOUT))
+        {
+            USB_TRACE(USB_TRACE_EVT_USBD_CDC_RECEIVE, usb_cdcHandle, num_bytes_received, NULL, 0U);
         }
-        USBH_Logf_Application("CDC data sent to Host: %s", (char*) temp_buffer);
     }
 }
 
 /***********************************************************************************
- *  Function Name: host_app
+ *  Function Name: device_stop
+ ***********************************************************************************
+ * Summary:
+ * Disconnects from the host and deinitializes emUSB-Device, so the endpoint
+ * buffer in the session pool can be released.
+ *
+ * Parameters:
+ * None
+ * 
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void device_stop(void)
+{
+    USBD_UnregisterSCHook(&usb_state_hook);
+    usb_suspend_report();
+    usb_suspend_deinit();
+
+    USBD_Stop();
+    USBD_DeInit();
+}
+
+/***********************************************************************************
+ *  Function Name: host_start
  ***********************************************************************************
  * Summary:
  * Initializes emUSB-Host stack and registers all necessary tasks.
- * After disconnection of the device, deinitializes the emUSB-Host.
  *
  * Parameters:
  * None
@@ -352,40 +723,41 @@ static void device_app(void)
  * void
  *
  **********************************************************************************/
-static void host_app(void)
+static void host_start(void)
 {
     USBH_STATUS usb_status;
-    BaseType_t rtos_task_status;
+
+    host_num_tasks = uxTaskGetNumberOfTasks();
+    usb_latency_reset();
+    app_metrics_set(APP_METRIC_HOST_DEVICES_ATTACHED, 0U);
 
     /* Initialize USBH stack */
     USBH_Init();
 
     /* Create two tasks mandatory for USBH operation */
 
-    USBH_Logf_Application("Register usbh_task task \r\n");
-    rtos_task_status = xTaskCreate(usbh_task, "usbh_task",
-                                   USB_MAIN_TASK_MEMORY_REQ, NULL, configMAX_PRIORITIES - 2, NULL);
-
-    if (rtos_task_status != pdPASS)
+    APP_LOG_INFO("Register usbh_task task \r\n");
+    if (usb_pool_create_task(usbh_task, "usbh_task",
+                             USB_MAIN_TASK_MEMORY_REQ, NULL, APP_PRIO_USBH_TASK) == NULL)
     {
         CY_ASSERT(0);
     }
 
-    USBH_Logf_Application("Register usbh_isr_task task \r\n");
-
-    rtos_task_status = xTaskCreate(usbh_isr_task, "usbh_isr_task",
-                                   USB_ISR_TASK_MEMORY_REQ, NULL, configMAX_PRIORITIES - 1, NULL);
-    if (rtos_task_status != pdPASS)
+    APP_LOG_INFO("Register usbh_isr_task task \r\n");
+    if (usb_pool_create_task(usbh_isr_task, "usbh_isr_task",
+                             USB_ISR_TASK_MEMORY_REQ, NULL, APP_PRIO_USBH_ISR_TASK) == NULL)
     {
         CY_ASSERT(0);
     }
 
-    USBH_Logf_Application("Initialize CDC classes \r\n");
+    APP_LOG_INFO("Initialize CDC classes \r\n");
 
     /* Initialize CDC classes */
     USBH_CDC_Init();
 
-    USBH_CDC_SetConfigFlags(USBH_CDC_IGNORE_INT_EP | USBH_CDC_DISABLE_INTERFACE_CHECK);
+    /* The interrupt endpoint carries the SERIAL_STATE notifications of the device */
+    USBH_CDC_SetConfigFlags(USBH_CDC_DISABLE_INTERFACE_CHECK);
+    cdc_serial_state_host_init();
     usb_status = USBH_CDC_AddNotification(&usbh_cdc_notification, usb_device_notify, NULL);
 
     if(usb_status != USBH_STATUS_SUCCESS)
@@ -393,25 +765,64 @@ static void host_app(void)
         CY_ASSERT(0);
     }
 
-    USBH_Logf_Application("Waiting for a USB CDC device \r\n\n");
+    /* With the multiplexer, all devices are read continuously instead of the echo test */
+    cdc_mux_start();
+}
+
+/***********************************************************************************
+ *  Function Name: host_app
+ ***********************************************************************************
+ * Summary:
+ * Runs the echo communication with the attached CDC device, unless the
+ * multiplexer reads the devices, see cdc_mux.c. Returns as soon as all devices
+ * were removed and the ID pin no longer selects the host role.
+ *
+ * Parameters:
+ * None
+ * 
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void host_app(void)
+{
+    APP_LOG_INFO("Waiting for a USB CDC device \r\n\n");
 
     uint32_t wait_counter = 10U;
 
     for (;;)
     {
-        USBH_OS_Delay(100U);
+        /* Wake up immediately when a device is added or removed, or a role swap is requested */
+        uint32_t events = otg_session_wait(OTG_SESSION_EVT_DEVICE_ADD | OTG_SESSION_EVT_DEVICE_REMOVE |
+                                           OTG_SESSION_EVT_ROLE_SWAP, 100U);
+
+        if (((events & OTG_SESSION_EVT_ROLE_SWAP) != 0U) && host_grant_swap())
+        {
+            break;
+        }
+
+        if (otg_role_swap_due())
+        {
+            otg_role_request_swap();
+        }
 
         if (device_ready)
         {
             wait_counter = 0U;
-            device_task();
+            if (!APP_CDC_MUX_ENABLE)
+            {
+                device_task();
+            }
         }
 
-        /* Check whether all devices were removed. */
-        if (USB_OTG_GetIdPin() != 0 && USBH_GetNumRootPortConnections(0) == 0)
+        /* Check whether all devices were removed. A swapped host role ends when
+         * the peer is gone, or did not connect in time. */
+        if ((otg_role_swapped() ? !otg_role_swap_pending() : (USB_OTG_GetIdPin() != 0)) &&
+            (USBH_GetNumRootPortConnections(0) == 0))
         {
             if (wait_counter == 0)
             {
+                usb_latency_report();
                 break;
             }
             wait_counter--;
@@ -419,6 +830,96 @@ static void host_app(void)
     }
 }
 
+/***********************************************************************************
+ *  Function Name: host_stop
+ ***********************************************************************************
+ * Summary:
+ * Stops the multiplexer and deinitializes emUSB-Host. usbh_task and
+ * usbh_isr_task return and delete themselves; their stacks live in the session
+ * pool, so wait until the idle task has removed them before the pool is reset.
+ *
+ * Parameters:
+ * None
+ * 
+ * Return:
+ * bool - false if the tasks did not exit within APP_USB_POOL_STOP_TIMEOUT_MS,
+ *        the pool must not be reset then
+ *
+ **********************************************************************************/
+static bool host_stop(void)
+{
+    TickType_t start;
+
+    device_ready = 0;
+    cdc_mux_stop();
+    USBH_DeInit();
+
+    start = xTaskGetTickCount();
+    while (uxTaskGetNumberOfTasks() > host_num_tasks)
+    {
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(APP_USB_POOL_STOP_TIMEOUT_MS))
+        {
+            APP_LOG_ERROR("%u emUSB-Host tasks still running, USB pool is kept",
+                          (unsigned int)(uxTaskGetNumberOfTasks() - host_num_tasks));
+            CY_ASSERT(0);
+            return false;
+        }
+        vTaskDelay(1U);
+    }
+
+    return true;
+}
+
+/***********************************************************************************
+ *  Function Name: host_grant_swap
+ ***********************************************************************************
+ * Summary:
+ * Grants a role swap: sends the HNP enable to the attached device as a
+ * SetLineCoding request at APP_OTG_HNP_ENABLE_RATE. The device then disconnects
+ * and both sides restart in the opposite role, see otg_role.c.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true if the swap was granted and the host session must end
+ *
+ **********************************************************************************/
+static bool host_grant_swap(void)
+{
+    USBH_CDC_HANDLE device_handle;
+    USBH_STATUS     usb_status = USBH_STATUS_ERROR;
+
+    /* The multiplexer readers hold the devices open, see app_config.c */
+    if (APP_CDC_MUX_ENABLE)
+    {
+        APP_LOG_ERROR("Role swap not supported with the CDC multiplexer");
+        otg_role_cancel();
+        return false;
+    }
+
+    device_handle = device_ready ? USBH_CDC_Open(device_index) : 0;
+    if (device_handle)
+    {
+        otg_session_handle_opened();
+        usb_status = USBH_CDC_SetCommParas(device_handle, APP_OTG_HNP_ENABLE_RATE, USBH_CDC_BITS_8,
+                                           USBH_CDC_STOP_BITS_1, USBH_CDC_PARITY_NONE);
+        USBH_CDC_Close(device_handle);
+        otg_session_handle_closed();
+    }
+
+    if (usb_status != USBH_STATUS_SUCCESS)
+    {
+        APP_LOG_ERROR("Role swap not possible, no CDC device");
+        otg_role_cancel();
+        return false;
+    }
+
+    APP_LOG_INFO("Role swap granted, restarting as device");
+    otg_role_grant();
+    return true;
+}
+
 /***********************************************************************************
  *  Function Name: usbh_task
  ***********************************************************************************
@@ -438,7 +939,7 @@ static void usbh_task(void* arg)
 
     USBH_Task();
 
-    USBH_Logf_Application("usbh_task was released");
+    APP_LOG_INFO("usbh_task was released");
     
     /* Delete the task as soon as emUSB-Host is released */
     vTaskDelete(NULL);
@@ -463,7 +964,7 @@ static void usbh_isr_task(void* arg)
 
     USBH_ISRTask();
 
-    USBH_Logf_Application("usbh_isr_task was released");
+    APP_LOG_INFO("usbh_isr_task was released");
     
     /* Delete the task as soon as emUSB-Host is released */
     vTaskDelete(NULL);
@@ -491,25 +992,39 @@ static void usb_device_notify(void* usb_context, uint8_t usb_index, USBH_DEVICE_
 {
     (void)usb_context;
 
+    USB_TRACE(USB_TRACE_EVT_USBH_DEVICE_EVENT, usb_index, usb_event, NULL, 0U);
+
     switch (usb_event)
     {
         case USBH_DEVICE_EVENT_ADD:
-            USBH_Logf_Application("======================== Device added [%d]" 
-                                  "========================\n\n\n\n", usb_index);
+            APP_LOG_INFO("======================== Device added [%d]" 
+                         "========================\n\n\n\n", usb_index);
+            cdc_host_rto_reset(usb_index);
             device_index = usb_index;
             device_ready = 1;
+            cdc_mux_attach(usb_index);
+            app_metrics_inc(APP_METRIC_HOST_DEVICES_ADDED);
+            app_metrics_inc(APP_METRIC_HOST_DEVICES_ATTACHED);
+            otg_session_ready();
+            otg_role_ready();
+            otg_session_signal(OTG_SESSION_EVT_DEVICE_ADD);
             break;
 
         case USBH_DEVICE_EVENT_REMOVE:
-            USBH_Logf_Application("======================== Device removed [%d]" 
-                                  "========================\n\n\n\n", usb_index);
+            APP_LOG_INFO("======================== Device removed [%d]" 
+                         "========================\n\n\n\n", usb_index);
+            cdc_host_rto_report(usb_index);
+            cdc_mux_detach(usb_index);
+            cdc_serial_state_host_detach();
+            app_metrics_sub(APP_METRIC_HOST_DEVICES_ATTACHED, 1U);
             device_ready = 0;
             device_index   = -1;
+            otg_session_signal(OTG_SESSION_EVT_DEVICE_REMOVE);
             break;
 
         default:
-            USBH_Logf_Application("======================== Invalid event [%d]" 
-                                  "========================\n\n\n\n", usb_index);
+            APP_LOG_ERROR("======================== Invalid event [%d]" 
+                          "========================\n\n\n\n", usb_index);
             break;
     }
 }
@@ -538,36 +1053,87 @@ static void device_task(void)
     {
         USBH_CDC_DEVICE_INFO usb_device_info;
         USBH_STATUS          usb_status;
-        unsigned long numBytes;
+        uint32_t             numBytes;
+        uint32_t             timeout_ms = cdc_host_rto_get_timeout(device_index);
+
+        otg_session_handle_opened();
 
-        /* Configure the CDC device. */
-        USBH_CDC_SetTimeouts(device_handle, 50, 50);
+        /* Configure the CDC device. Transfer timeouts adapt to the measured
+         * transfer times of the device, see cdc_host_rto.c */
+        USBH_CDC_SetTimeouts(device_handle, timeout_ms, timeout_ms);
         USBH_CDC_AllowShortRead(device_handle, 1);
         USBH_CDC_SetCommParas(device_handle, USBH_CDC_BAUD_115200, USBH_CDC_BITS_8,
                                 USBH_CDC_STOP_BITS_1, USBH_CDC_PARITY_NONE);
 
+        if (cdc_serial_state_host_attach(device_handle) != USBH_STATUS_SUCCESS)
+        {
+            APP_LOG_ERROR("Serial state notifications are not available");
+        }
+
         /* Retrieve the information about the CDC device */
         USBH_CDC_GetDeviceInfo(device_handle, &usb_device_info);
-        USBH_Logf_Application("Vendor  ID = 0x%.4X\n", usb_device_info.VendorId);
-        USBH_Logf_Application("Product ID = 0x%.4X\n", usb_device_info.ProductId);
-
-        USBH_Logf_Application("Writing to the device \"Hello Infineon!\"\n");
-        USBH_CDC_Write(device_handle, (const uint8_t *)"Hello Infineon!\n", 16U, &numBytes);
-        USBH_Logf_Application("Reading from the device\n");
-        usb_status = USBH_CDC_Read(device_handle, data_buffer, sizeof(data_buffer), &numBytes);
+        APP_LOG_INFO("Vendor  ID = 0x%.4X\n", usb_device_info.VendorId);
+        APP_LOG_INFO("Product ID = 0x%.4X\n", usb_device_info.ProductId);
 
-        if (usb_status != USBH_STATUS_SUCCESS)
+        /* Flow control: only send while the device reports DSR */
+        if (!cdc_serial_state_host_wait_ready(DELAY_ECHO_COMMUNICATION))
         {
-            USBH_Logf_Application("Error occurred during reading from device");
+            APP_LOG_INFO("Device is not ready to receive data\n");
         }
         else
         {
-            data_buffer[numBytes] = 0;
-            USBH_Logf_Application("Received: %s \n",(char *)data_buffer);
-            USBH_Logf_Application("Communication of USB Host with USB Device Successful\n");
+            APP_LOG_DATA("Writing to the device \"Hello Infineon!\"\n");
+            usb_status = cdc_host_rto_write(device_handle, device_index, (const uint8_t *)"Hello Infineon!\n",
+                                            16U, &numBytes);
+            USB_TRACE(USB_TRACE_EVT_USBH_CDC_WRITE, device_index, usb_status, "Hello Infineon!\n", numBytes);
+            APP_LOG_DATA("Reading from the device\n");
+            usb_status = cdc_host_rto_read(device_handle, device_index, data_buffer, sizeof(data_buffer) - 1U,
+                                           &numBytes);
+            USB_TRACE(USB_TRACE_EVT_USBH_CDC_READ, device_index, usb_status, data_buffer, numBytes);
+
+            /* Undo the transform of the device, see cdc_stream.c. The decoder
+             * returns 0 for a bad checksum or a truncated frame. */
+            if ((usb_status == USBH_STATUS_SUCCESS) && (numBytes != 0U))
+            {
+                numBytes = cdc_stream_decode(data_buffer, numBytes, sizeof(data_buffer) - 1U);
+                if (numBytes == 0U)
+                {
+                    usb_status = USBH_STATUS_ERROR;
+                    app_metrics_inc(APP_METRIC_HOST_ECHO_CORRUPT);
+                    APP_LOG_ERROR("Echo of the device is corrupt (%s stage)", cdc_stream_get_stage()->name);
+                }
+            }
+
+            if (usb_status != USBH_STATUS_SUCCESS)
+            {
+                APP_LOG_ERROR("Error occurred during reading from device");
+                cdc_host_rto_report(device_index);
+            }
+            else
+            {
+                data_buffer[numBytes] = 0;
+                APP_LOG_DATA("Received: %s \n",(char *)data_buffer);
+                APP_LOG_INFO("Communication of USB Host with USB Device Successful\n");
+            }
+        }
+
+        /* The device stays open until the next echo, so its notifications keep
+         * arriving. A role swap request of the device (ring signal) is signalled
+         * by the notification handler and ends the wait immediately, as does a
+         * removal. */
+        if (device_ready)
+        {
+            APP_LOG_INFO("Re-initiating echo communication in 5 seconds\n\n\n\n");
+            if ((otg_session_wait(OTG_SESSION_EVT_DEVICE_REMOVE | OTG_SESSION_EVT_ROLE_SWAP,
+                                  DELAY_ECHO_COMMUNICATION) & OTG_SESSION_EVT_ROLE_SWAP) != 0U)
+            {
+                /* Leave the swap to host_app() */
+                otg_session_signal(OTG_SESSION_EVT_ROLE_SWAP);
+            }
         }
 
-        USBH_Logf_Application("Re-initiating echo communication in 5 seconds\n\n\n\n");
-        XMC_Delay(DELAY_ECHO_COMMUNICATION);
+        /* Release the handle, emUSB-Host frees a removed device only after it is closed */
+        USBH_CDC_Close(device_handle);
+        otg_session_handle_closed();
     }
 }
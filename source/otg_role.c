@@ -0,0 +1,504 @@
+/*********************************************************************************
+* File Name        :   otg_role.c
+*
+* Description      :   Role swap between two OTG boards without a cable change, and
+*                      VBUS session request of the B-device.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+/* OTG header file includes */
+#include "USB_OTG.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_config.h"
+#include "app_log.h"
+#include "app_metrics.h"
+#include "otg_role.h"
+#include "otg_session.h"
+
+/*********************************************************************
+*
+*      Role swap protocol
+*
+*  emUSB-Host and emUSB-Device each own the USB core while they run,
+*  so the swap follows the HNP sequence in software:
+*
+*  1. A device that wants the host role raises the ring signal in its
+*     SERIAL_STATE notification, the host request flag of HNP.
+*  2. The host grants the swap, either on that request or on its own,
+*     with a SetLineCoding request at APP_OTG_HNP_ENABLE_RATE. This
+*     replaces SetFeature(b_hnp_enable), which emUSB-Device handles
+*     internally.
+*  3. Both sides end their session. The next session of each side runs
+*     the opposite role, regardless of the ID pin. The device stopping
+*     emUSB-Device is the disconnect that lets the new host take over.
+*  4. The swap is complete when the new session is ready. A swapped
+*     role that is not ready within APP_OTG_SWAP_TIMEOUT_MS, or whose
+*     peer is gone, falls back to the role selected by the ID pin.
+*
+*  The latency of each side is measured from the swap request, or from
+*  the grant if the peer requested the swap, to ready in the new role.
+*
+**********************************************************************/
+
+/* USB0 register bits used for SRP, see the XMC4400 reference manual */
+#define OTG_ROLE_GOTGCTL_SESREQSCS      (1UL << 0U)     /* Session request succeeded */
+#define OTG_ROLE_GOTGCTL_SESREQ         (1UL << 1U)     /* Session request */
+#define OTG_ROLE_GOTGCTL_BSESVLD        (1UL << 19U)    /* B-session valid, VBUS is present */
+#define OTG_ROLE_GUSBCFG_SRPCAP         (1UL << 8U)     /* SRP capable */
+
+typedef enum
+{
+    OTG_ROLE_AUTO = 0,          /* Role selected by the ID pin */
+    OTG_ROLE_HOST,
+    OTG_ROLE_DEVICE
+} otg_role_t;
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static volatile otg_role_t role_next;       /* Role of the next session, set by a swap */
+static bool                role_swapped;    /* The current session runs a role set by a swap */
+static volatile bool       swap_requested;  /* A swap was requested and not yet granted */
+static volatile bool       swap_active;     /* The swap was granted, the new role is not ready yet */
+static volatile TickType_t swap_tick;       /* Tick count when the swap started */
+static bool                session_ready;
+static TickType_t          ready_tick;
+static otg_role_stats_t    role_stats;
+
+/***********************************************************************************
+ *  Function Name: otg_role_select
+ ***********************************************************************************
+ * Summary:
+ * Selects the role of the next session. After a swap, this is the opposite of
+ * the previous role and the session starts without waiting for the ID pin.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * int - USB_OTG_ID_PIN_STATE_IS_HOST or USB_OTG_ID_PIN_STATE_IS_DEVICE after a
+ *       swap, USB_OTG_ID_PIN_STATE_IS_INVALID if the ID pin decides
+ *
+ **********************************************************************************/
+int otg_role_select(void)
+{
+    otg_role_t role = role_next;
+
+    role_next      = OTG_ROLE_AUTO;
+    role_swapped   = (role != OTG_ROLE_AUTO);
+    swap_requested = false;
+    session_ready  = false;
+
+    if (role == OTG_ROLE_AUTO)
+    {
+        /* The swapped session ended before it was ready */
+        if (swap_active)
+        {
+            swap_active = false;
+            role_stats.failures++;
+            app_metrics_inc(APP_METRIC_OTG_SWAP_FAILURES);
+        }
+        return USB_OTG_ID_PIN_STATE_IS_INVALID;
+    }
+
+    APP_LOG_INFO("OTG role swap: starting as %s", (role == OTG_ROLE_HOST) ? "host" : "device");
+
+    return (role == OTG_ROLE_HOST) ? USB_OTG_ID_PIN_STATE_IS_HOST : USB_OTG_ID_PIN_STATE_IS_DEVICE;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_swapped
+ ***********************************************************************************
+ * Summary:
+ * Returns whether the current session runs a role set by a swap. Such a session
+ * ends when its peer is gone, not when the ID pin changes.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true if the role was set by a swap
+ *
+ **********************************************************************************/
+bool otg_role_swapped(void)
+{
+    return role_swapped;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_request_swap
+ ***********************************************************************************
+ * Summary:
+ * Requests a role swap with the peer. In host role, the active session is asked
+ * to grant the swap. In device role, the request is passed to the host with the
+ * ring signal, see otg_role_host_requested(). Must be called from a task.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_request_swap(void)
+{
+    otg_session_state_t state = otg_session_get_state();
+
+    if (swap_requested || swap_active ||
+        ((state != OTG_SESSION_STATE_HOST_ACTIVE) && (state != OTG_SESSION_STATE_DEVICE_ACTIVE)))
+    {
+        return;
+    }
+
+    swap_tick      = xTaskGetTickCount();
+    swap_requested = true;
+
+    if (state == OTG_SESSION_STATE_HOST_ACTIVE)
+    {
+        otg_session_signal(OTG_SESSION_EVT_ROLE_SWAP);
+    }
+    else
+    {
+        APP_LOG_INFO("OTG role swap: requesting the host role");
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_host_requested
+ ***********************************************************************************
+ * Summary:
+ * Device: returns whether the ring signal must be raised to ask the host for
+ * a role swap.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true while the request waits for the grant of the host
+ *
+ **********************************************************************************/
+bool otg_role_host_requested(void)
+{
+    return swap_requested;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_grant
+ ***********************************************************************************
+ * Summary:
+ * Host: the HNP enable was sent to the device. The next session runs in device
+ * role.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_grant(void)
+{
+    if (!swap_requested)
+    {
+        swap_tick = xTaskGetTickCount();
+    }
+    swap_requested = false;
+    swap_active    = true;
+    role_next      = OTG_ROLE_DEVICE;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_cancel
+ ***********************************************************************************
+ * Summary:
+ * Host: discards a swap request that cannot be granted, for example because no
+ * device is attached.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_cancel(void)
+{
+    swap_requested = false;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_hnp_enable_from_isr
+ ***********************************************************************************
+ * Summary:
+ * Device: the host granted the swap. Ends the device session; the next session
+ * runs in host role. Called from the SetLineCoding callback of emUSB-Device.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_hnp_enable_from_isr(void)
+{
+    if (!swap_requested)
+    {
+        swap_tick = xTaskGetTickCountFromISR();
+    }
+    swap_requested = false;
+    swap_active    = true;
+    role_next      = OTG_ROLE_HOST;
+
+    otg_session_signal_from_isr(OTG_SESSION_EVT_ROLE_SWAP);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_ready
+ ***********************************************************************************
+ * Summary:
+ * Marks the session as ready, together with otg_session_ready(). Completes a
+ * swap and records its latency.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_ready(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t   latency_ms;
+
+    if (session_ready)
+    {
+        return;
+    }
+    session_ready = true;
+    ready_tick    = now;
+
+    if (!swap_active || !role_swapped)
+    {
+        return;
+    }
+    swap_active = false;
+
+    latency_ms = (uint32_t)(now - swap_tick) * portTICK_PERIOD_MS;
+    if ((role_stats.swaps == 0U) || (latency_ms < role_stats.min_ms))
+    {
+        role_stats.min_ms = latency_ms;
+    }
+    if (latency_ms > role_stats.max_ms)
+    {
+        role_stats.max_ms = latency_ms;
+    }
+    role_stats.sum_ms += latency_ms;
+    role_stats.swaps++;
+    app_metrics_inc(APP_METRIC_OTG_ROLE_SWAPS);
+    app_metrics_set(APP_METRIC_OTG_SWAP_LATENCY_MS, latency_ms);
+
+    APP_LOG_INFO("OTG role swap completed in %lu ms", (unsigned long)latency_ms);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_swap_pending
+ ***********************************************************************************
+ * Summary:
+ * Returns whether a swapped session still waits for its peer. After
+ * APP_OTG_SWAP_TIMEOUT_MS, the swap counts as failed and the session ends.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true while the new role may still become ready
+ *
+ **********************************************************************************/
+bool otg_role_swap_pending(void)
+{
+    if (!swap_active)
+    {
+        return false;
+    }
+
+    if (((uint32_t)(xTaskGetTickCount() - swap_tick) * portTICK_PERIOD_MS) < APP_OTG_SWAP_TIMEOUT_MS)
+    {
+        return true;
+    }
+
+    swap_active = false;
+    role_stats.failures++;
+    app_metrics_inc(APP_METRIC_OTG_SWAP_FAILURES);
+    APP_LOG_ERROR("OTG role swap timed out, falling back to the ID pin role");
+
+    return false;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_swap_due
+ ***********************************************************************************
+ * Summary:
+ * Swap test: returns true when the ready session has run for
+ * APP_OTG_SWAP_INTERVAL_MS and a swap should be requested.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true to request a swap now
+ *
+ **********************************************************************************/
+bool otg_role_swap_due(void)
+{
+#if (APP_OTG_SWAP_INTERVAL_MS == 0U)
+    return false;
+#else
+    if (!session_ready || swap_requested || swap_active)
+    {
+        return false;
+    }
+
+    return ((uint32_t)(xTaskGetTickCount() - ready_tick) * portTICK_PERIOD_MS) >= APP_OTG_SWAP_INTERVAL_MS;
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_request_session
+ ***********************************************************************************
+ * Summary:
+ * B-device: asks the A-device to turn on VBUS with the session request protocol
+ * (SRP) of the USB core, and waits up to APP_OTG_SRP_TIMEOUT_MS for the answer.
+ * Must be called while the OTG driver is running and no USB stack owns the core.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true if VBUS is present
+ *
+ **********************************************************************************/
+bool otg_role_request_session(void)
+{
+    TickType_t start = xTaskGetTickCount();
+    bool       granted;
+
+    if ((USB0->GOTGCTL & OTG_ROLE_GOTGCTL_BSESVLD) != 0U)
+    {
+        return true;
+    }
+
+    role_stats.session_requests++;
+    app_metrics_inc(APP_METRIC_OTG_SESSION_REQUESTS);
+    USB0->GUSBCFG |= OTG_ROLE_GUSBCFG_SRPCAP;
+    USB0->GOTGCTL |= OTG_ROLE_GOTGCTL_SESREQ;
+
+    do
+    {
+        vTaskDelay(1U);
+        granted = ((USB0->GOTGCTL & OTG_ROLE_GOTGCTL_SESREQSCS) != 0U);
+    } while (!granted && ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(APP_OTG_SRP_TIMEOUT_MS)));
+
+    USB0->GOTGCTL &= ~OTG_ROLE_GOTGCTL_SESREQ;
+
+    if (!granted)
+    {
+        role_stats.session_failures++;
+    }
+    APP_LOG_DATA("OTG session request %s", granted ? "granted" : "not answered");
+
+    return granted;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the role swap and session request statistics.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_get_stats(otg_role_stats_t* stats)
+{
+    *stats = role_stats;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_role_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the number of swaps, their latency and the session requests. Nothing is
+ * logged before the first swap or session request.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_role_report(void)
+{
+    if ((role_stats.swaps != 0U) || (role_stats.failures != 0U))
+    {
+        APP_LOG_INFO("OTG role swaps: %lu, failed %lu, latency min %lu ms, avg %lu ms, max %lu ms",
+                     (unsigned long)role_stats.swaps, (unsigned long)role_stats.failures,
+                     (unsigned long)role_stats.min_ms,
+                     (unsigned long)((role_stats.swaps != 0U) ? (role_stats.sum_ms / role_stats.swaps) : 0U),
+                     (unsigned long)role_stats.max_ms);
+    }
+
+    if (role_stats.session_requests != 0U)
+    {
+        APP_LOG_INFO("OTG session requests: %lu, not answered %lu",
+                     (unsigned long)role_stats.session_requests, (unsigned long)role_stats.session_failures);
+    }
+}
@@ -0,0 +1,75 @@
+/*********************************************************************************
+* File Name        :   otg_role.h
+*
+* Description      :   Public API of the OTG role swap and session request
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef OTG_ROLE_H
+#define OTG_ROLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t swaps;             /* Swaps that reached the new role */
+    uint32_t failures;          /* Swaps that fell back to the ID pin role */
+    uint32_t min_ms;            /* Swap request to ready in the new role, best case */
+    uint32_t max_ms;            /* Swap request to ready in the new role, worst case */
+    uint64_t sum_ms;            /* Sum of all swap latencies, for the average */
+    uint32_t session_requests;  /* SRP requests sent by the B-device */
+    uint32_t session_failures;  /* SRP requests the A-device did not answer */
+} otg_role_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int  otg_role_select(void);
+bool otg_role_swapped(void);
+void otg_role_request_swap(void);
+bool otg_role_host_requested(void);
+void otg_role_grant(void);
+void otg_role_cancel(void);
+void otg_role_hnp_enable_from_isr(void);
+void otg_role_ready(void);
+bool otg_role_swap_pending(void);
+bool otg_role_swap_due(void);
+bool otg_role_request_session(void);
+void otg_role_get_stats(otg_role_stats_t* stats);
+void otg_role_report(void);
+
+#endif /* OTG_ROLE_H */
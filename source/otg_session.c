@@ -0,0 +1,483 @@
+/*********************************************************************************
+* File Name        :   otg_session.c
+*
+* Description      :   OTG session state machine. Tracks the detect, host-active,
+*                      device-active and teardown states, delivers the USB events
+*                      of the active session to the main task, and measures the
+*                      recovery time and the resources left over by every session.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <malloc.h>
+#include <string.h>
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+#include "app_config.h"
+#include "app_log.h"
+#include "app_metrics.h"
+#include "app_timing.h"
+#include "otg_session.h"
+
+#define OTG_SESSION_EVT_ALL             (OTG_SESSION_EVT_DEVICE_ADD | OTG_SESSION_EVT_DEVICE_REMOVE | \
+                                         OTG_SESSION_EVT_DETACH | OTG_SESSION_EVT_ROLE_SWAP)
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static StaticEventGroup_t           session_event_memory;
+static EventGroupHandle_t           session_events;
+static volatile otg_session_state_t session_state;
+static otg_session_stats_t          session_stats;
+
+static uint32_t     teardown_stamp;         /* DWT cycles when the teardown started */
+static TickType_t   teardown_tick;          /* Tick count when the teardown started */
+static bool         teardown_done;          /* A teardown waits for the next ready session */
+static TickType_t   ready_tick;             /* Tick count when the session became ready */
+static bool         ready;
+static bool         baseline_valid;
+static UBaseType_t  baseline_tasks;
+static uint32_t     baseline_heap;
+
+static const char* const session_state_names[] =
+{
+    "detect", "host active", "device active", "teardown"
+};
+
+/***********************************************************************************
+ *  Function Name: session_heap_used
+ ***********************************************************************************
+ * Summary:
+ * Returns the number of heap bytes in use. heap_3 uses the C library heap.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * uint32_t - bytes allocated from the heap
+ *
+ **********************************************************************************/
+static uint32_t session_heap_used(void)
+{
+#if (configHEAP_ALLOCATION_SCHEME == HEAP_ALLOCATION_TYPE3)
+    return (uint32_t)mallinfo().uordblks;
+#else
+    return (uint32_t)(configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize());
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: session_check_leaks
+ ***********************************************************************************
+ * Summary:
+ * Compares the resources after a teardown with those after the first session.
+ * Anything a session leaves behind shows up as a growing difference.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+static void session_check_leaks(void)
+{
+    UBaseType_t tasks = uxTaskGetNumberOfTasks();
+    uint32_t    heap  = session_heap_used();
+
+    session_stats.handles_leaked += session_stats.handles_open;
+    session_stats.handles_open = 0U;
+
+    if (!baseline_valid)
+    {
+        baseline_tasks = tasks;
+        baseline_heap  = heap;
+        baseline_valid = true;
+    }
+
+    session_stats.tasks_leaked = (int32_t)tasks - (int32_t)baseline_tasks;
+    session_stats.heap_leaked  = (int32_t)heap - (int32_t)baseline_heap;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_init
+ ***********************************************************************************
+ * Summary:
+ * Creates the session event group and enters the detect state.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_init(void)
+{
+    app_timing_init();
+
+    session_events = xEventGroupCreateStatic(&session_event_memory);
+    session_state  = OTG_SESSION_STATE_DETECT;
+    memset(&session_stats, 0, sizeof(session_stats));
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_get_state
+ ***********************************************************************************
+ * Summary:
+ * Returns the current session state.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * otg_session_state_t - current state
+ *
+ **********************************************************************************/
+otg_session_state_t otg_session_get_state(void)
+{
+    return session_state;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_enter
+ ***********************************************************************************
+ * Summary:
+ * Moves the state machine to a new state. Entering an active state discards the
+ * events of the previous session. Entering the detect state from the teardown
+ * completes the session and checks it for leaked resources.
+ *
+ * Parameters:
+ * state - new state
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_enter(otg_session_state_t state)
+{
+    otg_session_state_t previous = session_state;
+
+    switch (state)
+    {
+        case OTG_SESSION_STATE_HOST_ACTIVE:
+        case OTG_SESSION_STATE_DEVICE_ACTIVE:
+            xEventGroupClearBits(session_events, OTG_SESSION_EVT_ALL);
+            ready = false;
+            app_metrics_inc((state == OTG_SESSION_STATE_HOST_ACTIVE) ?
+                            APP_METRIC_OTG_HOST_SESSIONS : APP_METRIC_OTG_DEVICE_SESSIONS);
+            break;
+
+        case OTG_SESSION_STATE_TEARDOWN:
+            teardown_stamp = app_timing_now();
+            teardown_tick  = xTaskGetTickCount();
+            teardown_done  = false;
+            ready = false;
+            break;
+
+        case OTG_SESSION_STATE_DETECT:
+        default:
+            if (previous == OTG_SESSION_STATE_TEARDOWN)
+            {
+                uint32_t teardown_us = app_timing_cycles_to_us(app_timing_now() - teardown_stamp);
+
+                if (teardown_us > session_stats.teardown_max_us)
+                {
+                    session_stats.teardown_max_us = teardown_us;
+                }
+                session_stats.sessions++;
+                teardown_done = true;
+                session_check_leaks();
+
+                if ((APP_OTG_STRESS_CYCLES == 0U) ||
+                    ((session_stats.sessions % APP_OTG_STRESS_REPORT_INTERVAL) == 0U) ||
+                    (session_stats.sessions == APP_OTG_STRESS_CYCLES))
+                {
+                    otg_session_report();
+                }
+            }
+            state = OTG_SESSION_STATE_DETECT;
+            break;
+    }
+
+    APP_LOG_DATA("OTG session: %s -> %s", session_state_names[previous], session_state_names[state]);
+    session_state = state;
+    app_metrics_set(APP_METRIC_OTG_STATE, (uint32_t)state);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_ready
+ ***********************************************************************************
+ * Summary:
+ * Marks the active session as usable: the device is enumerated, or the host has
+ * found a CDC device. The time since the previous teardown is the recovery time.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_ready(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (ready)
+    {
+        return;
+    }
+    ready      = true;
+    ready_tick = now;
+
+    if (teardown_done)
+    {
+        uint32_t recovery_ms = (uint32_t)(now - teardown_tick) * portTICK_PERIOD_MS;
+
+        teardown_done = false;
+
+        if ((session_stats.recoveries == 0U) || (recovery_ms < session_stats.recovery_min_ms))
+        {
+            session_stats.recovery_min_ms = recovery_ms;
+        }
+        if (recovery_ms > session_stats.recovery_max_ms)
+        {
+            session_stats.recovery_max_ms = recovery_ms;
+        }
+        session_stats.recovery_sum_ms += recovery_ms;
+        session_stats.recoveries++;
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_signal
+ ***********************************************************************************
+ * Summary:
+ * Signals events of the active session. Must be called from task context, for
+ * example from emUSB-Host notification callbacks.
+ *
+ * Parameters:
+ * events - OTG_SESSION_EVT_* bits
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_signal(uint32_t events)
+{
+    xEventGroupSetBits(session_events, events);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_signal_from_isr
+ ***********************************************************************************
+ * Summary:
+ * Signals events of the active session from an interrupt, for example from the
+ * emUSB-Device state change hook.
+ *
+ * Parameters:
+ * events - OTG_SESSION_EVT_* bits
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_signal_from_isr(uint32_t events)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    xEventGroupSetBitsFromISR(session_events, events, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_wait
+ ***********************************************************************************
+ * Summary:
+ * Waits for one of the given events and consumes it. Used instead of fixed delays
+ * so a detach interrupts the wait immediately.
+ *
+ * Parameters:
+ * events     - OTG_SESSION_EVT_* bits to wait for
+ * timeout_ms - maximum time to wait
+ *
+ * Return:
+ * uint32_t - the events that occurred, 0 on timeout
+ *
+ **********************************************************************************/
+uint32_t otg_session_wait(uint32_t events, uint32_t timeout_ms)
+{
+    return (uint32_t)xEventGroupWaitBits(session_events, events, pdTRUE, pdFALSE,
+                                         pdMS_TO_TICKS(timeout_ms)) & events;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_pending
+ ***********************************************************************************
+ * Summary:
+ * Checks for events without consuming them.
+ *
+ * Parameters:
+ * events - OTG_SESSION_EVT_* bits
+ *
+ * Return:
+ * bool - true if one of the events occurred
+ *
+ **********************************************************************************/
+bool otg_session_pending(uint32_t events)
+{
+    return ((xEventGroupGetBits(session_events) & events) != 0U);
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_handle_opened
+ ***********************************************************************************
+ * Summary:
+ * Counts a CDC handle opened in the current session. Every handle must be closed
+ * again with otg_session_handle_closed() before the session ends.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_handle_opened(void)
+{
+    session_stats.handles_open++;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_handle_closed
+ ***********************************************************************************
+ * Summary:
+ * Counts a closed CDC handle.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_handle_closed(void)
+{
+    if (session_stats.handles_open > 0U)
+    {
+        session_stats.handles_open--;
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_stress_due
+ ***********************************************************************************
+ * Summary:
+ * Stress test: returns true when the ready session has been held for
+ * APP_OTG_STRESS_HOLD_MS and should be detached to start the next cycle.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true to end the session now
+ *
+ **********************************************************************************/
+bool otg_session_stress_due(void)
+{
+#if (APP_OTG_STRESS_CYCLES == 0U)
+    return false;
+#else
+    if ((session_stats.sessions >= APP_OTG_STRESS_CYCLES) || !ready)
+    {
+        return false;
+    }
+
+    return ((uint32_t)(xTaskGetTickCount() - ready_tick) * portTICK_PERIOD_MS) >= APP_OTG_STRESS_HOLD_MS;
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the session statistics.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_get_stats(otg_session_stats_t* stats)
+{
+    *stats = session_stats;
+}
+
+/***********************************************************************************
+ *  Function Name: otg_session_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the session count, the recovery times and the leaked resources.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void otg_session_report(void)
+{
+    APP_LOG_INFO("OTG sessions: %lu, teardown max %lu us, leaked: %lu handles, %ld tasks, %ld heap bytes",
+                 (unsigned long)session_stats.sessions, (unsigned long)session_stats.teardown_max_us,
+                 (unsigned long)session_stats.handles_leaked, (long)session_stats.tasks_leaked,
+                 (long)session_stats.heap_leaked);
+
+    if (session_stats.recoveries != 0U)
+    {
+        APP_LOG_INFO("OTG recovery: min %lu ms, avg %lu ms, max %lu ms",
+                     (unsigned long)session_stats.recovery_min_ms,
+                     (unsigned long)(session_stats.recovery_sum_ms / session_stats.recoveries),
+                     (unsigned long)session_stats.recovery_max_ms);
+    }
+}
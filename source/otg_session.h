@@ -0,0 +1,93 @@
+/*********************************************************************************
+* File Name        :   otg_session.h
+*
+* Description      :   Interface of the OTG session state machine
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef OTG_SESSION_H
+#define OTG_SESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* States of an OTG session */
+typedef enum
+{
+    OTG_SESSION_STATE_DETECT = 0,       /* USB OTG driver polls the ID pin */
+    OTG_SESSION_STATE_HOST_ACTIVE,      /* emUSB-Host is running */
+    OTG_SESSION_STATE_DEVICE_ACTIVE,    /* emUSB-Device is running */
+    OTG_SESSION_STATE_TEARDOWN          /* USB stack is shut down, session memory is released */
+} otg_session_state_t;
+
+/* Events of the active session, see otg_session_wait() */
+#define OTG_SESSION_EVT_DEVICE_ADD      (1UL << 0U)     /* Host: a CDC device was added */
+#define OTG_SESSION_EVT_DEVICE_REMOVE   (1UL << 1U)     /* Host: a CDC device was removed */
+#define OTG_SESSION_EVT_DETACH          (1UL << 2U)     /* Device: VBUS or the host was lost */
+#define OTG_SESSION_EVT_ROLE_SWAP       (1UL << 3U)     /* The session ends for a role swap, see otg_role.c */
+
+typedef struct
+{
+    uint32_t sessions;          /* Completed sessions */
+    uint32_t recoveries;        /* Sessions that became ready after a teardown */
+    uint32_t recovery_min_ms;   /* Teardown to ready again, best case */
+    uint32_t recovery_max_ms;   /* Teardown to ready again, worst case */
+    uint64_t recovery_sum_ms;   /* Sum of all recovery times, for the average */
+    uint32_t teardown_max_us;   /* Longest shutdown of the USB stack */
+    uint32_t handles_open;      /* CDC handles opened in the current session */
+    uint32_t handles_leaked;    /* CDC handles still open at the end of a session */
+    int32_t  tasks_leaked;      /* Tasks left over compared to the first session */
+    int32_t  heap_leaked;       /* Heap bytes lost compared to the first session */
+} otg_session_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void                otg_session_init(void);
+otg_session_state_t otg_session_get_state(void);
+void                otg_session_enter(otg_session_state_t state);
+void                otg_session_ready(void);
+void                otg_session_signal(uint32_t events);
+void                otg_session_signal_from_isr(uint32_t events);
+uint32_t            otg_session_wait(uint32_t events, uint32_t timeout_ms);
+bool                otg_session_pending(uint32_t events);
+void                otg_session_handle_opened(void);
+void                otg_session_handle_closed(void);
+bool                otg_session_stress_due(void);
+void                otg_session_get_stats(otg_session_stats_t* stats);
+void                otg_session_report(void);
+
+#endif /* OTG_SESSION_H */
@@ -0,0 +1,717 @@
+/*********************************************************************************
+* File Name        :   stream_kernels.c
+*
+* Description      :   In-place CDC stream processing kernels: byte order, checksum,
+*                      SLIP and COBS framing. The word-at-a-time versions use the
+*                      Cortex-M4 SIMD instructions (UADD8, SEL, USADA8, REV) when
+*                      the compiler targets the DSP extension, and portable SWAR
+*                      code otherwise.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "stream_kernels.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define STREAM_SIMD                 (1)
+#else
+#define STREAM_SIMD                 (0)
+#endif
+
+/***********************************************************************************
+ *  Function Name: load32
+ ***********************************************************************************
+ * Summary:
+ * Loads a word from any address. The Cortex-M4 supports unaligned LDR, so this
+ * compiles to a single load.
+ *
+ **********************************************************************************/
+static inline uint32_t load32(const uint8_t* p)
+{
+    uint32_t word;
+
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/***********************************************************************************
+ *  Function Name: store32
+ ***********************************************************************************
+ * Summary:
+ * Stores a word to any address.
+ *
+ **********************************************************************************/
+static inline void store32(uint8_t* p, uint32_t word)
+{
+    memcpy(p, &word, sizeof(word));
+}
+
+/***********************************************************************************
+ *  Function Name: match_bytes
+ ***********************************************************************************
+ * Summary:
+ * Compares the four bytes of a word with a byte value.
+ *
+ * Parameters:
+ * word  - four input bytes
+ * value - byte value to look for
+ *
+ * Return:
+ * uint32_t - 0xFF in every byte position that equals value, 0x00 elsewhere
+ *
+ **********************************************************************************/
+static inline uint32_t match_bytes(uint32_t word, uint32_t value)
+{
+    uint32_t x = word ^ (value * 0x01010101U);
+
+#if STREAM_SIMD
+    /* x + 0xFF carries out of every non-zero byte and sets its GE flag,
+     * SEL then selects 0x00 for those bytes and 0xFF for the matches */
+    (void)__UADD8(x, 0xFFFFFFFFU);
+    return __SEL(0U, 0xFFFFFFFFU);
+#else
+    /* 0x80 in every zero byte of x, without false positives */
+    uint32_t zero = ~(((x & 0x7F7F7F7FU) + 0x7F7F7F7FU) | x | 0x7F7F7F7FU);
+
+    return (zero >> 7) * 0xFFU;
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: bswap
+ ***********************************************************************************
+ * Summary:
+ * Reverses the byte order of a word.
+ *
+ **********************************************************************************/
+static inline uint32_t bswap(uint32_t word)
+{
+#if STREAM_SIMD
+    return __REV(word);
+#else
+    return (word >> 24) | ((word >> 8) & 0x0000FF00U) | ((word << 8) & 0x00FF0000U) | (word << 24);
+#endif
+}
+
+/***********************************************************************************
+ *  Function Name: stream_sum8
+ ***********************************************************************************
+ * Summary:
+ * Returns the sum of all bytes.
+ *
+ * Parameters:
+ * data   - input bytes
+ * length - number of bytes
+ *
+ * Return:
+ * uint32_t - sum of the bytes
+ *
+ **********************************************************************************/
+uint32_t stream_sum8(const uint8_t* data, uint32_t length)
+{
+    uint32_t sum = 0U;
+    uint32_t i   = 0U;
+
+#if STREAM_SIMD
+    /* Sum of absolute differences to zero adds four bytes at once */
+    for (; (i + 4U) <= length; i += 4U)
+    {
+        sum = __USADA8(load32(&data[i]), 0U, sum);
+    }
+#else
+    while ((i + 4U) <= length)
+    {
+        /* Two 16-bit lanes sum the even and odd bytes. 128 words fit into a
+         * lane without overflow, then the lanes are folded into the sum. */
+        uint32_t lanes = 0U;
+        uint32_t end   = ((length - i) > 512U) ? (i + 512U) : length;
+
+        for (; (i + 4U) <= end; i += 4U)
+        {
+            uint32_t word = load32(&data[i]);
+
+            lanes += (word & 0x00FF00FFU) + ((word >> 8) & 0x00FF00FFU);
+        }
+        sum += (lanes & 0xFFFFU) + (lanes >> 16);
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_sum8_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_sum8().
+ *
+ **********************************************************************************/
+uint32_t stream_sum8_scalar(const uint8_t* data, uint32_t length)
+{
+    uint32_t sum = 0U;
+
+    for (uint32_t i = 0U; i < length; i++)
+    {
+        sum += data[i];
+    }
+
+    return sum;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_bswap32
+ ***********************************************************************************
+ * Summary:
+ * Converts a stream of 32-bit words between little and big endian. Trailing
+ * bytes that do not form a complete word are left unchanged.
+ *
+ * Parameters:
+ * data   - stream, converted in place
+ * length - number of bytes
+ * size   - not used, the length does not change
+ *
+ * Return:
+ * uint32_t - length
+ *
+ **********************************************************************************/
+uint32_t stream_bswap32(uint8_t* data, uint32_t length, uint32_t size)
+{
+    (void)size;
+
+    for (uint32_t i = 0U; (i + 4U) <= length; i += 4U)
+    {
+        store32(&data[i], bswap(load32(&data[i])));
+    }
+
+    return length;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_bswap32_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_bswap32().
+ *
+ **********************************************************************************/
+uint32_t stream_bswap32_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    (void)size;
+
+    for (uint32_t i = 0U; (i + 4U) <= length; i += 4U)
+    {
+        uint8_t tmp = data[i];
+
+        data[i]      = data[i + 3U];
+        data[i + 3U] = tmp;
+        tmp          = data[i + 1U];
+        data[i + 1U] = data[i + 2U];
+        data[i + 2U] = tmp;
+    }
+
+    return length;
+}
+
+/***********************************************************************************
+ *  Function Name: checksum_append
+ ***********************************************************************************
+ * Summary:
+ * Appends a 16-bit checksum in little endian byte order.
+ *
+ **********************************************************************************/
+static inline uint32_t checksum_append(uint8_t* data, uint32_t length, uint32_t size, uint32_t sum)
+{
+    data[length]      = (uint8_t)sum;
+    data[length + 1U] = (uint8_t)(sum >> 8);
+    (void)size;
+
+    return length + 2U;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_checksum_append
+ ***********************************************************************************
+ * Summary:
+ * Appends the 16-bit sum of all bytes to the stream.
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes
+ * size   - capacity of data, at least STREAM_CHECKSUM_MAX_SIZE(length)
+ *
+ * Return:
+ * uint32_t - new length, 0 if the checksum does not fit
+ *
+ **********************************************************************************/
+uint32_t stream_checksum_append(uint8_t* data, uint32_t length, uint32_t size)
+{
+    if (size < STREAM_CHECKSUM_MAX_SIZE(length))
+    {
+        return 0U;
+    }
+
+    return checksum_append(data, length, size, stream_sum8(data, length));
+}
+
+/***********************************************************************************
+ *  Function Name: stream_checksum_append_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_checksum_append().
+ *
+ **********************************************************************************/
+uint32_t stream_checksum_append_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    if (size < STREAM_CHECKSUM_MAX_SIZE(length))
+    {
+        return 0U;
+    }
+
+    return checksum_append(data, length, size, stream_sum8_scalar(data, length));
+}
+
+/***********************************************************************************
+ *  Function Name: stream_checksum_verify
+ ***********************************************************************************
+ * Summary:
+ * Checks and removes the checksum added by stream_checksum_append().
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes, including the checksum
+ * size   - not used
+ *
+ * Return:
+ * uint32_t - length without the checksum, 0 if the checksum is wrong
+ *
+ **********************************************************************************/
+uint32_t stream_checksum_verify(uint8_t* data, uint32_t length, uint32_t size)
+{
+    uint32_t sum;
+
+    (void)size;
+
+    if (length < 2U)
+    {
+        return 0U;
+    }
+
+    length -= 2U;
+    sum = stream_sum8(data, length) & 0xFFFFU;
+
+    return (sum == ((uint32_t)data[length] | ((uint32_t)data[length + 1U] << 8))) ? length : 0U;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_checksum_verify_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_checksum_verify().
+ *
+ **********************************************************************************/
+uint32_t stream_checksum_verify_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    uint32_t sum;
+
+    (void)size;
+
+    if (length < 2U)
+    {
+        return 0U;
+    }
+
+    length -= 2U;
+    sum = stream_sum8_scalar(data, length) & 0xFFFFU;
+
+    return (sum == ((uint32_t)data[length] | ((uint32_t)data[length + 1U] << 8))) ? length : 0U;
+}
+
+/***********************************************************************************
+ *  Function Name: slip_encode
+ ***********************************************************************************
+ * Summary:
+ * SLIP encoder. The input is moved to the end of the buffer and encoded towards
+ * the start; the worst case size guarantees that the output never overtakes the
+ * unread input. With words set, words without special characters are copied
+ * as a whole.
+ *
+ **********************************************************************************/
+static inline uint32_t slip_encode(uint8_t* data, uint32_t length, uint32_t size, bool words)
+{
+    uint8_t* src;
+    uint32_t out = 0U;
+    uint32_t i   = 0U;
+
+    if (size < STREAM_SLIP_MAX_SIZE(length))
+    {
+        return 0U;
+    }
+
+    src = &data[size - length];
+    memmove(src, data, length);
+
+    while (i < length)
+    {
+        if (words && ((i + 4U) <= length))
+        {
+            uint32_t word = load32(&src[i]);
+
+            if ((match_bytes(word, STREAM_SLIP_END) | match_bytes(word, STREAM_SLIP_ESC)) == 0U)
+            {
+                store32(&data[out], word);
+                out += 4U;
+                i   += 4U;
+                continue;
+            }
+        }
+
+        uint8_t c = src[i++];
+
+        if (c == STREAM_SLIP_END)
+        {
+            data[out++] = STREAM_SLIP_ESC;
+            data[out++] = STREAM_SLIP_ESC_END;
+        }
+        else if (c == STREAM_SLIP_ESC)
+        {
+            data[out++] = STREAM_SLIP_ESC;
+            data[out++] = STREAM_SLIP_ESC_ESC;
+        }
+        else
+        {
+            data[out++] = c;
+        }
+    }
+
+    data[out++] = STREAM_SLIP_END;
+
+    return out;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_slip_encode
+ ***********************************************************************************
+ * Summary:
+ * Encodes the stream as one SLIP frame, terminated by an END character.
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes
+ * size   - capacity of data, at least STREAM_SLIP_MAX_SIZE(length)
+ *
+ * Return:
+ * uint32_t - new length, 0 if the worst case result does not fit
+ *
+ **********************************************************************************/
+uint32_t stream_slip_encode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    return slip_encode(data, length, size, true);
+}
+
+/***********************************************************************************
+ *  Function Name: stream_slip_encode_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_slip_encode().
+ *
+ **********************************************************************************/
+uint32_t stream_slip_encode_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    return slip_encode(data, length, size, false);
+}
+
+/***********************************************************************************
+ *  Function Name: slip_decode
+ ***********************************************************************************
+ * Summary:
+ * SLIP decoder. With words set, words without special characters are
+ * copied as a whole.
+ *
+ **********************************************************************************/
+static inline uint32_t slip_decode(uint8_t* data, uint32_t length, bool words)
+{
+    uint32_t out = 0U;
+    uint32_t i   = 0U;
+
+    /* A frame that does not end with END is truncated */
+    if ((length == 0U) || (data[length - 1U] != STREAM_SLIP_END))
+    {
+        return 0U;
+    }
+
+    while (i < length)
+    {
+        if (words && ((i + 4U) <= length))
+        {
+            uint32_t word = load32(&data[i]);
+
+            if ((match_bytes(word, STREAM_SLIP_END) | match_bytes(word, STREAM_SLIP_ESC)) == 0U)
+            {
+                store32(&data[out], word);
+                out += 4U;
+                i   += 4U;
+                continue;
+            }
+        }
+
+        uint8_t c = data[i++];
+
+        if (c == STREAM_SLIP_END)
+        {
+            continue;
+        }
+
+        if (c == STREAM_SLIP_ESC)
+        {
+            /* The final END guarantees a byte after ESC */
+            c = data[i++];
+
+            if (c == STREAM_SLIP_ESC_END)
+            {
+                c = STREAM_SLIP_END;
+            }
+            else if (c == STREAM_SLIP_ESC_ESC)
+            {
+                c = STREAM_SLIP_ESC;
+            }
+            else
+            {
+                return 0U;
+            }
+        }
+
+        data[out++] = c;
+    }
+
+    return out;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_slip_decode
+ ***********************************************************************************
+ * Summary:
+ * Decodes SLIP frames. END characters are removed, escape sequences are
+ * replaced by the original bytes. The data must end with an END character.
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes
+ * size   - not used, the stream only shrinks
+ *
+ * Return:
+ * uint32_t - new length, 0 if the frame is truncated or holds an invalid
+ *            escape sequence
+ *
+ **********************************************************************************/
+uint32_t stream_slip_decode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    (void)size;
+
+    return slip_decode(data, length, true);
+}
+
+/***********************************************************************************
+ *  Function Name: stream_slip_decode_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_slip_decode().
+ *
+ **********************************************************************************/
+uint32_t stream_slip_decode_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    (void)size;
+
+    return slip_decode(data, length, false);
+}
+
+/***********************************************************************************
+ *  Function Name: cobs_encode
+ ***********************************************************************************
+ * Summary:
+ * COBS encoder, same buffer layout as slip_encode(). With words set, words
+ * without a zero byte are copied as a whole while the current block has room.
+ *
+ **********************************************************************************/
+static inline uint32_t cobs_encode(uint8_t* data, uint32_t length, uint32_t size, bool words)
+{
+    uint8_t* src;
+    uint32_t code_pos = 0U;
+    uint32_t code     = 1U;
+    uint32_t out      = 1U;
+    uint32_t i        = 0U;
+
+    if (size < STREAM_COBS_MAX_SIZE(length))
+    {
+        return 0U;
+    }
+
+    src = &data[size - length];
+    memmove(src, data, length);
+
+    while (i < length)
+    {
+        if (words && ((i + 4U) <= length) && (code <= 0xFAU))
+        {
+            uint32_t word = load32(&src[i]);
+
+            if (match_bytes(word, 0U) == 0U)
+            {
+                store32(&data[out], word);
+                out  += 4U;
+                code += 4U;
+                i    += 4U;
+                continue;
+            }
+        }
+
+        uint8_t c = src[i++];
+
+        if (c == 0U)
+        {
+            data[code_pos] = (uint8_t)code;
+            code     = 1U;
+            code_pos = out++;
+        }
+        else
+        {
+            data[out++] = c;
+            code++;
+
+            /* A block holds at most 254 data bytes */
+            if ((code == 0xFFU) && (i < length))
+            {
+                data[code_pos] = (uint8_t)code;
+                code     = 1U;
+                code_pos = out++;
+            }
+        }
+    }
+
+    data[code_pos] = (uint8_t)code;
+    data[out++]    = 0U;
+
+    return out;
+}
+
+/***********************************************************************************
+ *  Function Name: stream_cobs_encode
+ ***********************************************************************************
+ * Summary:
+ * Encodes the stream as one COBS frame, terminated by a zero byte.
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes
+ * size   - capacity of data, at least STREAM_COBS_MAX_SIZE(length)
+ *
+ * Return:
+ * uint32_t - new length, 0 if the worst case result does not fit
+ *
+ **********************************************************************************/
+uint32_t stream_cobs_encode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    return cobs_encode(data, length, size, true);
+}
+
+/***********************************************************************************
+ *  Function Name: stream_cobs_encode_scalar
+ ***********************************************************************************
+ * Summary:
+ * Reference version of stream_cobs_encode().
+ *
+ **********************************************************************************/
+uint32_t stream_cobs_encode_scalar(uint8_t* data, uint32_t length, uint32_t size)
+{
+    return cobs_encode(data, length, size, false);
+}
+
+/***********************************************************************************
+ *  Function Name: stream_cobs_decode
+ ***********************************************************************************
+ * Summary:
+ * Decodes one COBS frame. Decoding stops at the zero byte that ends the frame.
+ *
+ * Parameters:
+ * data   - stream
+ * length - number of bytes
+ * size   - not used, the stream only shrinks
+ *
+ * Return:
+ * uint32_t - new length, 0 if the frame is truncated
+ *
+ **********************************************************************************/
+uint32_t stream_cobs_decode(uint8_t* data, uint32_t length, uint32_t size)
+{
+    uint32_t out = 0U;
+    uint32_t in  = 0U;
+
+    (void)size;
+
+    while (in < length)
+    {
+        uint32_t code = data[in++];
+        uint32_t run  = code - 1U;
+
+        if (code == 0U)
+        {
+            break;
+        }
+
+        if (run > (length - in))
+        {
+            return 0U;
+        }
+
+        /* Data bytes are copied as a block */
+        memmove(&data[out], &data[in], run);
+        out += run;
+        in  += run;
+
+        if ((code != 0xFFU) && (in < length) && (data[in] != 0U))
+        {
+            data[out++] = 0U;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,93 @@
+/*********************************************************************************
+* File Name        :   stream_kernels.h
+*
+* Description      :   Interface of the in-place CDC stream processing kernels
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef STREAM_KERNELS_H
+#define STREAM_KERNELS_H
+
+#include <stdint.h>
+
+/*
+ * All kernels work in place on data[0..length) and return the new length.
+ * size is the capacity of data; kernels that enlarge the stream return 0 if
+ * the worst case result does not fit. The plain functions process a word at
+ * a time, using the Cortex-M4 SIMD instructions where available. The
+ * *_scalar variants process one byte at a time and serve as reference for
+ * tests and benchmarks.
+ *
+ * This file has no dependencies on the target, so the PC tools build it too.
+ */
+
+/* SLIP special characters, RFC 1055 */
+#define STREAM_SLIP_END             (0xC0U)
+#define STREAM_SLIP_ESC             (0xDBU)
+#define STREAM_SLIP_ESC_END         (0xDCU)
+#define STREAM_SLIP_ESC_ESC         (0xDDU)
+
+/* Worst case output sizes of the encoders for n input bytes */
+#define STREAM_SLIP_MAX_SIZE(n)     ((2U * (n)) + 1U)
+#define STREAM_COBS_MAX_SIZE(n)     ((n) + ((n) / 254U) + 2U)
+#define STREAM_CHECKSUM_MAX_SIZE(n) ((n) + 2U)
+
+typedef uint32_t (*stream_kernel_t)(uint8_t* data, uint32_t length, uint32_t size);
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t stream_sum8(const uint8_t* data, uint32_t length);
+uint32_t stream_sum8_scalar(const uint8_t* data, uint32_t length);
+
+uint32_t stream_bswap32(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_bswap32_scalar(uint8_t* data, uint32_t length, uint32_t size);
+
+uint32_t stream_checksum_append(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_checksum_append_scalar(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_checksum_verify(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_checksum_verify_scalar(uint8_t* data, uint32_t length, uint32_t size);
+
+uint32_t stream_slip_encode(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_slip_encode_scalar(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_slip_decode(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_slip_decode_scalar(uint8_t* data, uint32_t length, uint32_t size);
+
+uint32_t stream_cobs_encode(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_cobs_encode_scalar(uint8_t* data, uint32_t length, uint32_t size);
+uint32_t stream_cobs_decode(uint8_t* data, uint32_t length, uint32_t size);
+
+#endif /* STREAM_KERNELS_H */
@@ -0,0 +1,234 @@
+/*********************************************************************************
+* File Name        :   usb_latency.c
+*
+* Description      :   Measures the worst-case wakeup latency from the USB host
+*                      interrupt to usbh_isr_task. The emUSB-Host OS layer calls
+*                      are intercepted with the linker option --wrap (see Makefile),
+*                      so the middleware sources stay unmodified.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "usb_latency.h"
+
+#if (USB_LATENCY_ENABLE)
+
+/* emUSB-Host header file includes */
+#include "USBH.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_log.h"
+#include "app_timing.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static volatile uint32_t    latency_isr_stamp;
+static volatile bool        latency_pending;
+static usb_latency_stats_t  latency_stats;
+
+/* Original emUSB-Host OS layer functions, resolved by the linker */
+void __real_USBH_OS_SignalISREx(U32 DevIndex);
+U32  __real_USBH_OS_WaitISR(void);
+
+/***********************************************************************************
+ *  Function Name: __wrap_USBH_OS_SignalISREx
+ ***********************************************************************************
+ * Summary:
+ * Called by the emUSB-Host interrupt handler to wake up usbh_isr_task. Stores
+ * the time stamp of the first signal that has not been consumed yet.
+ *
+ * Parameters:
+ * DevIndex - index of the host controller
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void __wrap_USBH_OS_SignalISREx(U32 DevIndex)
+{
+    if (!latency_pending)
+    {
+        latency_isr_stamp = app_timing_now();
+        latency_pending   = true;
+    }
+
+    __real_USBH_OS_SignalISREx(DevIndex);
+}
+
+/***********************************************************************************
+ *  Function Name: __wrap_USBH_OS_WaitISR
+ ***********************************************************************************
+ * Summary:
+ * Called by usbh_isr_task to wait for the interrupt. Measures the time from the
+ * interrupt until the task runs again.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * U32 - value returned by the original function
+ *
+ **********************************************************************************/
+U32 __wrap_USBH_OS_WaitISR(void)
+{
+    U32         result = __real_USBH_OS_WaitISR();
+    uint32_t    now = app_timing_now();
+    uint32_t    stamp;
+    uint32_t    latency_us;
+    uint32_t    bucket = 0U;
+    bool        pending;
+    UBaseType_t mask;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    pending         = latency_pending;
+    stamp           = latency_isr_stamp;
+    latency_pending = false;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    if (pending)
+    {
+        latency_us = app_timing_cycles_to_us(now - stamp);
+
+        while ((bucket < (USB_LATENCY_BUCKETS - 1U)) && ((latency_us >> bucket) != 0U))
+        {
+            bucket++;
+        }
+
+        if ((latency_stats.count == 0U) || (latency_us < latency_stats.min_us))
+        {
+            latency_stats.min_us = latency_us;
+        }
+        if (latency_us > latency_stats.max_us)
+        {
+            latency_stats.max_us = latency_us;
+        }
+        latency_stats.sum_us += latency_us;
+        latency_stats.count++;
+        latency_stats.histogram[bucket]++;
+    }
+
+    return result;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_latency_reset
+ ***********************************************************************************
+ * Summary:
+ * Clears the statistics. Call before a session starts.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_latency_reset(void)
+{
+    app_timing_init();
+
+    memset(&latency_stats, 0, sizeof(latency_stats));
+    latency_pending = false;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_latency_get
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the statistics.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_latency_get(usb_latency_stats_t* stats)
+{
+    taskENTER_CRITICAL();
+    *stats = latency_stats;
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************
+ *  Function Name: usb_latency_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the statistics and the non-empty histogram buckets.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_latency_report(void)
+{
+    usb_latency_stats_t stats;
+    uint32_t i;
+
+    usb_latency_get(&stats);
+
+    if (stats.count == 0U)
+    {
+        APP_LOG_INFO("USB ISR latency: no samples");
+        return;
+    }
+
+    APP_LOG_INFO("USB ISR latency: min %lu us, avg %lu us, max %lu us (%lu samples)",
+                 (unsigned long)stats.min_us, (unsigned long)(stats.sum_us / stats.count),
+                 (unsigned long)stats.max_us, (unsigned long)stats.count);
+
+    for (i = 0U; i < USB_LATENCY_BUCKETS; i++)
+    {
+        if (stats.histogram[i] != 0U)
+        {
+            APP_LOG_INFO("  < %5lu us: %lu", (unsigned long)(1UL << i), (unsigned long)stats.histogram[i]);
+        }
+    }
+}
+
+#endif /* USB_LATENCY_ENABLE */
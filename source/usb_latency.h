@@ -0,0 +1,83 @@
+/*********************************************************************************
+* File Name        :   usb_latency.h
+*
+* Description      :   Interface for measuring the wakeup latency from the USB
+*                      host interrupt to usbh_isr_task
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_LATENCY_H
+#define USB_LATENCY_H
+
+#include <stdint.h>
+
+/***********************************************************************************
+ *  Define configurables
+ **********************************************************************************/
+/* Set USB_LATENCY=1 on the make command line to enable the measurement */
+#ifndef USB_LATENCY_ENABLE
+#define USB_LATENCY_ENABLE          (0)
+#endif
+
+/* Histogram bucket n counts latencies in [2^(n-1), 2^n) us, bucket 0 is < 1 us */
+#define USB_LATENCY_BUCKETS         (16U)
+
+typedef struct
+{
+    uint32_t count;                             /* Number of measured wakeups */
+    uint32_t min_us;                            /* Best case latency */
+    uint32_t max_us;                            /* Worst case latency */
+    uint64_t sum_us;                            /* Sum of all latencies, for the average */
+    uint32_t histogram[USB_LATENCY_BUCKETS];    /* Latency distribution */
+} usb_latency_stats_t;
+
+#if (USB_LATENCY_ENABLE)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void usb_latency_reset(void);
+void usb_latency_get(usb_latency_stats_t* stats);
+void usb_latency_report(void);
+
+#else
+
+#define usb_latency_reset()         do { } while (0)
+#define usb_latency_report()        do { } while (0)
+
+#endif /* USB_LATENCY_ENABLE */
+
+#endif /* USB_LATENCY_H */
@@ -0,0 +1,216 @@
+/*********************************************************************************
+* File Name        :   usb_pool.c
+*
+* Description      :   Static memory pool of the USB sessions. Allocation is a
+*                      pointer bump and the whole pool is released in O(1) when
+*                      a session ends, so repeated OTG cycles have deterministic
+*                      allocation time and cannot fragment the heap.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_config.h"
+#include "app_log.h"
+#include "app_metrics.h"
+#include "usb_pool.h"
+
+/* All allocations are aligned to 8 bytes, as required for task stacks */
+#define USB_POOL_ALIGN(x)           (((x) + 7U) & ~(size_t)7U)
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static uint64_t         usb_pool_memory[USB_POOL_ALIGN(APP_USB_POOL_SIZE) / sizeof(uint64_t)];
+static usb_pool_stats_t usb_pool_stats = { .size = sizeof(usb_pool_memory) };
+
+/***********************************************************************************
+ *  Function Name: usb_pool_alloc
+ ***********************************************************************************
+ * Summary:
+ * Allocates memory for the current session. The memory is released with all
+ * other allocations of the session by usb_pool_reset(); there is no free.
+ *
+ * Parameters:
+ * size - number of bytes
+ *
+ * Return:
+ * void* - 8-byte aligned memory, or NULL if the pool is exhausted
+ *
+ **********************************************************************************/
+void* usb_pool_alloc(size_t size)
+{
+    void* memory = NULL;
+
+    size = USB_POOL_ALIGN(size);
+
+    taskENTER_CRITICAL();
+
+    if ((size != 0U) && (size <= (usb_pool_stats.size - usb_pool_stats.used)))
+    {
+        memory = (uint8_t*)usb_pool_memory + usb_pool_stats.used;
+        usb_pool_stats.used += size;
+        usb_pool_stats.allocs++;
+
+        if (usb_pool_stats.used > usb_pool_stats.peak)
+        {
+            usb_pool_stats.peak = usb_pool_stats.used;
+        }
+        app_metrics_set(APP_METRIC_POOL_USED, usb_pool_stats.used);
+        app_metrics_max(APP_METRIC_POOL_PEAK, usb_pool_stats.used);
+    }
+    else
+    {
+        usb_pool_stats.failures++;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return memory;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_pool_create_task
+ ***********************************************************************************
+ * Summary:
+ * Creates a task with its stack and control block taken from the pool, so no
+ * heap memory is used per session. The task must have deleted itself and the
+ * idle task must have removed it before the pool is reset.
+ *
+ * Parameters:
+ * task        - task function
+ * name        - task name
+ * stack_depth - stack size in words
+ * arg         - argument of the task function
+ * priority    - task priority
+ *
+ * Return:
+ * TaskHandle_t - handle of the task, or NULL if the pool is exhausted
+ *
+ **********************************************************************************/
+TaskHandle_t usb_pool_create_task(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                                  void* arg, UBaseType_t priority)
+{
+    StackType_t*  stack = usb_pool_alloc(stack_depth * sizeof(StackType_t));
+    StaticTask_t* tcb   = usb_pool_alloc(sizeof(StaticTask_t));
+
+    if ((stack == NULL) || (tcb == NULL))
+    {
+        return NULL;
+    }
+
+    return xTaskCreateStatic(task, name, stack_depth, arg, priority, stack, tcb);
+}
+
+/***********************************************************************************
+ *  Function Name: usb_pool_reset
+ ***********************************************************************************
+ * Summary:
+ * Releases all allocations of the session. Call only after the USB stack and all
+ * tasks using pool memory have been shut down.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_pool_reset(void)
+{
+    taskENTER_CRITICAL();
+
+    if (usb_pool_stats.peak > usb_pool_stats.peak_overall)
+    {
+        usb_pool_stats.peak_overall = usb_pool_stats.peak;
+    }
+    usb_pool_stats.used     = 0U;
+    usb_pool_stats.peak     = 0U;
+    usb_pool_stats.allocs   = 0U;
+    usb_pool_stats.failures = 0U;
+    usb_pool_stats.sessions++;
+    app_metrics_set(APP_METRIC_POOL_USED, 0U);
+
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************
+ *  Function Name: usb_pool_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the pool statistics.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_pool_get_stats(usb_pool_stats_t* stats)
+{
+    taskENTER_CRITICAL();
+    *stats = usb_pool_stats;
+    taskEXIT_CRITICAL();
+}
+
+/***********************************************************************************
+ *  Function Name: usb_pool_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the usage of the current session. Call before usb_pool_reset().
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_pool_report(void)
+{
+    usb_pool_stats_t stats;
+
+    usb_pool_get_stats(&stats);
+
+    APP_LOG_INFO("USB pool: peak %lu of %lu bytes, %lu allocations, %lu failed",
+                 (unsigned long)stats.peak, (unsigned long)stats.size,
+                 (unsigned long)stats.allocs, (unsigned long)stats.failures);
+}
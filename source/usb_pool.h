@@ -0,0 +1,72 @@
+/*********************************************************************************
+* File Name        :   usb_pool.h
+*
+* Description      :   Interface of the static memory pool of the USB sessions
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_POOL_H
+#define USB_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct
+{
+    uint32_t size;              /* Size of the pool in bytes */
+    uint32_t used;              /* Bytes allocated in the current session */
+    uint32_t peak;              /* Highest usage of the current session */
+    uint32_t peak_overall;      /* Highest usage of all sessions */
+    uint32_t allocs;            /* Allocations in the current session */
+    uint32_t failures;          /* Failed allocations in the current session */
+    uint32_t sessions;          /* Number of completed sessions (resets) */
+} usb_pool_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void* usb_pool_alloc(size_t size);
+TaskHandle_t usb_pool_create_task(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                                  void* arg, UBaseType_t priority);
+void  usb_pool_reset(void);
+void  usb_pool_get_stats(usb_pool_stats_t* stats);
+void  usb_pool_report(void);
+
+#endif /* USB_POOL_H */
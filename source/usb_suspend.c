@@ -0,0 +1,322 @@
+/*********************************************************************************
+* File Name        :   usb_suspend.c
+*
+* Description      :   USB device suspend/resume handling. Keeps the CDC session
+*                      across bus suspend, lets the core sleep while suspended
+*                      and measures the resume to first byte latency.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+
+/* MTB header file includes*/
+#include "cybsp.h"
+
+/* emUSB-Device header file includes */
+#include "USB.h"
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_log.h"
+#include "app_metrics.h"
+#include "app_timing.h"
+#include "usb_suspend.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+static TaskHandle_t         suspend_task;
+static volatile bool        suspend_active;
+static volatile bool        resume_pending;
+static volatile uint32_t    resume_stamp;
+static usb_suspend_stats_t  suspend_stats;
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_on_state_change
+ ***********************************************************************************
+ * Summary:
+ * Call from the emUSB-Device state change hook of the device session. This
+ * hook is called directly from an ISR in most cases, but not always. Stores the
+ * time of the resume and wakes up the task waiting in usb_suspend_wait_resume().
+ *
+ * Parameters:
+ * NewState - new USB_STAT_* state of the device
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_on_state_change(U8 NewState)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    TaskHandle_t task = suspend_task;
+    bool suspended = ((NewState & USB_STAT_SUSPENDED) != 0U);
+
+    if (suspend_active && !suspended)
+    {
+        resume_stamp   = app_timing_now();
+        resume_pending = true;
+    }
+    suspend_active = suspended;
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    if (xPortIsInsideInterrupt() != pdFALSE)
+    {
+        vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+    else
+    {
+        (void)xTaskNotifyGive(task);
+    }
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_init
+ ***********************************************************************************
+ * Summary:
+ * Resets the suspend state of a new device session. Must be called by the task
+ * running the device session, before USBD_Start(). The state changes are
+ * passed in with usb_suspend_on_state_change().
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_init(void)
+{
+    app_timing_init();
+
+    suspend_active = false;
+    resume_pending = false;
+    suspend_task   = xTaskGetCurrentTaskHandle();
+    memset(&suspend_stats, 0, sizeof(suspend_stats));
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_deinit
+ ***********************************************************************************
+ * Summary:
+ * Stops waking the session task. Call when the device session ends, after the
+ * state change hook was unregistered.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_deinit(void)
+{
+    suspend_task   = NULL;
+    suspend_active = false;
+    resume_pending = false;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_is_active
+ ***********************************************************************************
+ * Summary:
+ * Returns whether the bus is suspended. Used by the idle hook to put the core
+ * to sleep.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * bool - true while the bus is suspended
+ *
+ **********************************************************************************/
+bool usb_suspend_is_active(void)
+{
+    return suspend_active;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_wait_resume
+ ***********************************************************************************
+ * Summary:
+ * Blocks the calling task while the bus is suspended. The CDC instance and its
+ * buffers stay configured, so data flow continues as soon as the host resumes.
+ * Returns early when the device is detached.
+ *
+ * Parameters:
+ * timeout_ms - maximum suspend time before the session is given up
+ *
+ * Return:
+ * bool - true if the bus was resumed, false on detach or timeout
+ *
+ **********************************************************************************/
+bool usb_suspend_wait_resume(uint32_t timeout_ms)
+{
+    TickType_t start   = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    TickType_t elapsed;
+    int        dev_state;
+
+    suspend_stats.suspends++;
+    app_metrics_inc(APP_METRIC_DEVICE_SUSPENDS);
+    APP_LOG_INFO("USB suspended, waiting for resume");
+
+    for (;;)
+    {
+        dev_state = USBD_GetState();
+
+        if (((dev_state & USB_STAT_ATTACHED) == 0U) || ((dev_state & USB_STAT_CONFIGURED) == 0U))
+        {
+            return false;
+        }
+        if ((dev_state & USB_STAT_SUSPENDED) == 0U)
+        {
+            break;
+        }
+        elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout)
+        {
+            APP_LOG_INFO("USB suspended for more than %lu ms", (unsigned long)timeout_ms);
+            return false;
+        }
+
+        /* Sleep until the state changes, the idle hook halts the core meanwhile */
+        (void)ulTaskNotifyTake(pdTRUE, timeout - elapsed);
+    }
+
+    suspend_stats.resumes++;
+    APP_LOG_INFO("USB resumed");
+    return true;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_on_data
+ ***********************************************************************************
+ * Summary:
+ * Call whenever data has been received. The first call after a resume records
+ * the resume to first byte latency.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_on_data(void)
+{
+    uint32_t latency_us;
+
+    if (!resume_pending)
+    {
+        return;
+    }
+
+    latency_us     = app_timing_cycles_to_us(app_timing_now() - resume_stamp);
+    resume_pending = false;
+
+    if ((suspend_stats.samples == 0U) || (latency_us < suspend_stats.min_us))
+    {
+        suspend_stats.min_us = latency_us;
+    }
+    if (latency_us > suspend_stats.max_us)
+    {
+        suspend_stats.max_us = latency_us;
+    }
+    suspend_stats.sum_us += latency_us;
+    suspend_stats.samples++;
+
+    APP_LOG_INFO("Resume to first byte: %lu us", (unsigned long)latency_us);
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_get_stats
+ ***********************************************************************************
+ * Summary:
+ * Returns a copy of the suspend statistics of the current session.
+ *
+ * Parameters:
+ * stats - destination of the copy
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_get_stats(usb_suspend_stats_t* stats)
+{
+    *stats = suspend_stats;
+}
+
+/***********************************************************************************
+ *  Function Name: usb_suspend_report
+ ***********************************************************************************
+ * Summary:
+ * Logs the suspend statistics of the current session.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_suspend_report(void)
+{
+    if (suspend_stats.suspends == 0U)
+    {
+        return;
+    }
+
+    APP_LOG_INFO("USB suspend: %lu suspends, %lu resumes", (unsigned long)suspend_stats.suspends,
+                 (unsigned long)suspend_stats.resumes);
+
+    if (suspend_stats.samples != 0U)
+    {
+        APP_LOG_INFO("Resume to first byte: min %lu us, avg %lu us, max %lu us",
+                     (unsigned long)suspend_stats.min_us,
+                     (unsigned long)(suspend_stats.sum_us / suspend_stats.samples),
+                     (unsigned long)suspend_stats.max_us);
+    }
+}
@@ -0,0 +1,72 @@
+/*********************************************************************************
+* File Name        :   usb_suspend.h
+*
+* Description      :   Interface of the USB device suspend/resume handling
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_SUSPEND_H
+#define USB_SUSPEND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* emUSB-Device header file includes */
+#include "USB.h"
+
+typedef struct
+{
+    uint32_t suspends;          /* Number of suspend periods */
+    uint32_t resumes;           /* Number of resumes that kept the session */
+    uint32_t samples;           /* Resumes followed by received data */
+    uint32_t min_us;            /* Best case resume to first byte latency */
+    uint32_t max_us;            /* Worst case resume to first byte latency */
+    uint64_t sum_us;            /* Sum of all latencies, for the average */
+} usb_suspend_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void usb_suspend_init(void);
+void usb_suspend_deinit(void);
+void usb_suspend_on_state_change(U8 NewState);
+bool usb_suspend_is_active(void);
+bool usb_suspend_wait_resume(uint32_t timeout_ms);
+void usb_suspend_on_data(void);
+void usb_suspend_get_stats(usb_suspend_stats_t* stats);
+void usb_suspend_report(void);
+
+#endif /* USB_SUSPEND_H */
@@ -0,0 +1,228 @@
+/*********************************************************************************
+* File Name        :   usb_trace.c
+*
+* Description      :   Records the calls made at the emUSB API boundary into a
+*                      compact binary RAM trace that can be replayed on a host PC.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "usb_trace.h"
+
+#if (USB_TRACE_ENABLE)
+
+/* FreeRTOS header file */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_log.h"
+#include "app_timing.h"
+
+/*********************************************************************
+*
+*      Global Variables
+*
+**********************************************************************/
+/* The trace is kept as the exact binary image expected by the replay tool, so
+ * it can also be saved with the debugger (dump binary memory ...). */
+static union
+{
+    USB_TRACE_HEADER header;
+    uint8_t          bytes[USB_TRACE_BUFFER_SIZE];
+} usb_trace_buffer;
+
+static uint32_t usb_trace_last_cycles;
+static uint64_t usb_trace_total_cycles;
+static uint32_t usb_trace_last_us;
+
+/***********************************************************************************
+ *  Function Name: usb_trace_init
+ ***********************************************************************************
+ * Summary:
+ * Clears the trace buffer and starts a new trace.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_trace_init(void)
+{
+    UBaseType_t mask;
+
+    app_timing_init();
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    usb_trace_buffer.header.magic           = USB_TRACE_MAGIC;
+    usb_trace_buffer.header.version         = USB_TRACE_VERSION;
+    usb_trace_buffer.header.flags           = 0U;
+    usb_trace_buffer.header.length          = 0U;
+    usb_trace_buffer.header.record_count    = 0U;
+
+    usb_trace_last_cycles  = app_timing_now();
+    usb_trace_total_cycles = 0U;
+    usb_trace_last_us      = 0U;
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/***********************************************************************************
+ *  Function Name: usb_trace_record
+ ***********************************************************************************
+ * Summary:
+ * Appends one record to the trace. Can be called from tasks and from ISRs.
+ * When the buffer is full, the record is dropped and the overflow flag is set.
+ *
+ * Parameters:
+ * event        - traced event
+ * index        - device index or CDC instance
+ * result       - return value or status of the traced call
+ * payload      - data transferred by the call, may be NULL
+ * payload_len  - number of payload bytes, truncated to USB_TRACE_MAX_PAYLOAD
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_trace_record(USB_TRACE_EVENT event, uint8_t index, int32_t result,
+                      const void* payload, uint32_t payload_len)
+{
+    USB_TRACE_RECORD* record;
+    UBaseType_t mask;
+    uint32_t    offset;
+    uint32_t    size;
+    uint32_t    now;
+    uint32_t    now_us;
+
+    /* Failed calls pass a negative byte count, which carries no payload */
+    if ((payload == NULL) || (payload_len > 0x7FFFFFFFUL))
+    {
+        payload_len = 0U;
+    }
+    else if (payload_len > USB_TRACE_MAX_PAYLOAD)
+    {
+        payload_len = USB_TRACE_MAX_PAYLOAD;
+    }
+
+    size = sizeof(USB_TRACE_RECORD) + USB_TRACE_ALIGN(payload_len);
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    /* Extend the 32-bit cycle counter, so long idle periods do not wrap */
+    now = app_timing_now();
+    usb_trace_total_cycles += (uint32_t)(now - usb_trace_last_cycles);
+    usb_trace_last_cycles   = now;
+    now_us = (uint32_t)((usb_trace_total_cycles * 1000000U) / SystemCoreClock);
+
+    offset = sizeof(USB_TRACE_HEADER) + usb_trace_buffer.header.length;
+
+    if ((offset + size) > sizeof(usb_trace_buffer.bytes))
+    {
+        usb_trace_buffer.header.flags |= USB_TRACE_FLAG_OVERFLOW;
+    }
+    else
+    {
+        record = (USB_TRACE_RECORD*)&usb_trace_buffer.bytes[offset];
+        record->event       = (uint8_t)event;
+        record->index       = index;
+        record->payload_len = (uint16_t)payload_len;
+        record->result      = result;
+        record->delta_us    = now_us - usb_trace_last_us;
+
+        memset(&usb_trace_buffer.bytes[offset + sizeof(USB_TRACE_RECORD)], 0,
+               USB_TRACE_ALIGN(payload_len));
+        if (payload_len > 0U)
+        {
+            memcpy(&usb_trace_buffer.bytes[offset + sizeof(USB_TRACE_RECORD)], payload, payload_len);
+        }
+
+        usb_trace_buffer.header.length += size;
+        usb_trace_buffer.header.record_count++;
+        usb_trace_last_us = now_us;
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/***********************************************************************************
+ *  Function Name: usb_trace_dump
+ ***********************************************************************************
+ * Summary:
+ * Prints the trace as hex lines prefixed with "UTRC:" on the debug UART and
+ * starts a new trace. Save the terminal output to a file and pass it to the
+ * usb_replay tool. The log lock keeps queued log messages out of the dump.
+ *
+ * Parameters:
+ * None
+ *
+ * Return:
+ * void
+ *
+ **********************************************************************************/
+void usb_trace_dump(void)
+{
+    uint32_t total = sizeof(USB_TRACE_HEADER) + usb_trace_buffer.header.length;
+    uint32_t i;
+
+    app_log_lock();
+    printf("UTRC-BEGIN %lu records%s\r\n", (unsigned long)usb_trace_buffer.header.record_count,
+           ((usb_trace_buffer.header.flags & USB_TRACE_FLAG_OVERFLOW) != 0U) ? " (overflow)" : "");
+
+    for (i = 0U; i < total; i++)
+    {
+        if ((i % USB_TRACE_DUMP_LINE_BYTES) == 0U)
+        {
+            printf("UTRC:");
+        }
+        printf("%02X", usb_trace_buffer.bytes[i]);
+        if ((((i + 1U) % USB_TRACE_DUMP_LINE_BYTES) == 0U) || ((i + 1U) == total))
+        {
+            printf("\r\n");
+        }
+    }
+
+    printf("UTRC-END\r\n");
+    app_log_unlock();
+
+    usb_trace_init();
+}
+
+#endif /* USB_TRACE_ENABLE */
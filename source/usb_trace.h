@@ -0,0 +1,82 @@
+/*********************************************************************************
+* File Name        :   usb_trace.h
+*
+* Description      :   Interface of the USB call trace recorder
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_TRACE_H
+#define USB_TRACE_H
+
+#include <stdint.h>
+
+#include "usb_trace_format.h"
+
+/***********************************************************************************
+ *  Define configurables
+ **********************************************************************************/
+/* Set USB_TRACE_ENABLE=1 in the Makefile DEFINES to record the USB call trace */
+#ifndef USB_TRACE_ENABLE
+#define USB_TRACE_ENABLE            (0)
+#endif
+
+/* Size of the RAM trace buffer, including the header */
+#ifndef USB_TRACE_BUFFER_SIZE
+#define USB_TRACE_BUFFER_SIZE       (8192U)
+#endif
+
+#if (USB_TRACE_ENABLE)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void usb_trace_init(void);
+void usb_trace_record(USB_TRACE_EVENT event, uint8_t index, int32_t result,
+                      const void* payload, uint32_t payload_len);
+void usb_trace_dump(void);
+
+#define USB_TRACE(event, index, result, payload, payload_len) \
+    usb_trace_record((event), (uint8_t)(index), (int32_t)(result), (payload), (uint32_t)(payload_len))
+
+#else
+
+#define usb_trace_init()            do { } while (0)
+#define usb_trace_dump()            do { } while (0)
+#define USB_TRACE(event, index, result, payload, payload_len) do { (void)(result); } while (0)
+
+#endif /* USB_TRACE_ENABLE */
+
+#endif /* USB_TRACE_H */
@@ -0,0 +1,105 @@
+/*********************************************************************************
+* File Name        :   usb_trace_format.h
+*
+* Description      :   Binary layout of the USB call trace. Shared between the
+*                      firmware recorder and the host replay tool, so this header
+*                      must not depend on any target specific header.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_TRACE_FORMAT_H
+#define USB_TRACE_FORMAT_H
+
+#include <stdint.h>
+
+/*********************************************************************
+*
+*      Trace layout
+*
+*  A trace is a USB_TRACE_HEADER followed by a sequence of records.
+*  Each record is a USB_TRACE_RECORD followed by payload_len bytes of
+*  payload, padded with zeros to a multiple of 4 bytes. All fields are
+*  little endian.
+*
+**********************************************************************/
+#define USB_TRACE_MAGIC             (0x43525455UL)  /* "UTRC" */
+#define USB_TRACE_VERSION           (1U)
+
+/* Maximum number of payload bytes stored per record */
+#define USB_TRACE_MAX_PAYLOAD       (64U)
+
+/* Number of trace bytes per "UTRC:" line of usb_trace_dump(), only the last
+ * line of a dump is shorter */
+#define USB_TRACE_DUMP_LINE_BYTES   (32U)
+
+#define USB_TRACE_FLAG_OVERFLOW     (0x0001U)       /* Records were dropped, buffer was full */
+
+#define USB_TRACE_ALIGN(x)          (((x) + 3U) & ~3U)
+
+typedef enum
+{
+    USB_TRACE_EVT_SESSION_HOST      = 0x01, /* Host session started */
+    USB_TRACE_EVT_SESSION_DEVICE    = 0x02, /* Device session started */
+    USB_TRACE_EVT_SESSION_END       = 0x03, /* Session torn down */
+    USB_TRACE_EVT_USBD_CDC_RECEIVE  = 0x10, /* result = USBD_CDC_Receive() return value */
+    USB_TRACE_EVT_USBD_CDC_WRITE    = 0x11, /* result = USBD_CDC_Write() return value */
+    USB_TRACE_EVT_USBD_STATE        = 0x12, /* result = USBD_GetState() */
+    USB_TRACE_EVT_USBH_CDC_READ     = 0x20, /* result = USBH_STATUS, payload = data read */
+    USB_TRACE_EVT_USBH_CDC_WRITE    = 0x21, /* result = USBH_STATUS, payload = data written */
+    USB_TRACE_EVT_USBH_DEVICE_EVENT = 0x22, /* result = USBH_DEVICE_EVENT, index = device index */
+    USB_TRACE_EVT_ALLOC             = 0x30, /* result = requested size */
+    USB_TRACE_EVT_FREE              = 0x31  /* result = 0 */
+} USB_TRACE_EVENT;
+
+typedef struct
+{
+    uint32_t magic;             /* USB_TRACE_MAGIC */
+    uint16_t version;           /* USB_TRACE_VERSION */
+    uint16_t flags;             /* USB_TRACE_FLAG_* */
+    uint32_t length;            /* Number of record bytes following the header */
+    uint32_t record_count;      /* Number of records following the header */
+} USB_TRACE_HEADER;
+
+typedef struct
+{
+    uint8_t  event;             /* USB_TRACE_EVENT */
+    uint8_t  index;             /* Device index or CDC instance */
+    uint16_t payload_len;       /* Number of payload bytes stored after the record */
+    int32_t  result;            /* Return value / status of the traced call */
+    uint32_t delta_us;          /* Time since the previous record in microseconds */
+} USB_TRACE_RECORD;
+
+#endif /* USB_TRACE_FORMAT_H */
@@ -0,0 +1,394 @@
+/*********************************************************************************
+* File Name        :   metrics_query.c
+*
+* Description      :   Host (Linux) tool that reads the metrics registry of a board in
+*                      device role with the EP0 snapshot request of app_metrics.c and
+*                      prints the counters and gauges, optionally as rates.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*
+ * Build:   gcc -O2 -Wall -I../../source -o metrics_query metrics_query.c
+ * Usage:   metrics_query [-d <usbfs path>] [-I <interface>] [-w <ms>]
+ *          metrics_query -r <snapshot file>
+ *
+ * Without -d, the first device with the VID/PID of the application
+ * (058B:027D) is searched in /sys/bus/usb/devices. The request is a vendor
+ * request on EP0, so the CDC ACM driver can stay bound to the device and
+ * the serial port remains usable. Access to /dev/bus/usb needs root or a
+ * udev rule.
+ *
+ *   -d     usbfs device node, for example /dev/bus/usb/001/007.
+ *   -I     Interface number of the metrics interface. Default is
+ *          APP_METRICS_INTERFACE.
+ *   -w     Watch mode: query every <ms> milliseconds and print the rate of
+ *          every counter per second of target uptime next to its value.
+ *   -r     Decode a raw snapshot saved from the response of a request, or
+ *          with app_metrics_snapshot() and the debugger, instead of querying.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <linux/usbdevice_fs.h>
+
+#include "app_metrics_format.h"
+
+#define QUERY_VENDOR_ID             (0x058BU)
+#define QUERY_PRODUCT_ID            (0x027DU)
+#define QUERY_TIMEOUT_MS            (1000U)
+
+/* Largest response: the header and the values of 255 metrics */
+#define QUERY_MAX_SIZE              (sizeof(APP_METRICS_HEADER) + (255U * sizeof(uint32_t)))
+
+typedef struct
+{
+    const char* module;
+    const char* name;
+    int         type;
+} query_metric_t;
+
+#define QUERY_METRIC(id, type, module, name)    { module, name, APP_METRIC_TYPE_##type },
+
+static const query_metric_t query_metrics[APP_METRIC_COUNT] =
+{
+    APP_METRICS_LIST(QUERY_METRIC)
+};
+
+typedef struct
+{
+    uint8_t  total;
+    uint16_t sequence;
+    uint32_t uptime_ms;
+    uint32_t values[255];
+} query_snapshot_t;
+
+static uint32_t read_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* Decodes one response into the snapshot, returns the index of the next
+ * metric or -1 if the response is invalid */
+static int decode(const uint8_t* data, size_t length, query_snapshot_t* snapshot)
+{
+    uint8_t first;
+    uint8_t count;
+
+    if (length < sizeof(APP_METRICS_HEADER))
+    {
+        fprintf(stderr, "Response is truncated (%zu bytes)\n", length);
+        return -1;
+    }
+    if ((read_u16(&data[0]) != APP_METRICS_MAGIC) || (data[2] != APP_METRICS_VERSION))
+    {
+        fprintf(stderr, "Not a metrics snapshot (version %u expected)\n", APP_METRICS_VERSION);
+        return -1;
+    }
+
+    first = data[4];
+    count = data[5];
+    if ((length < (sizeof(APP_METRICS_HEADER) + (count * sizeof(uint32_t)))) ||
+        ((first + count) > data[3]))
+    {
+        fprintf(stderr, "Corrupt snapshot\n");
+        return -1;
+    }
+
+    snapshot->total     = data[3];
+    snapshot->sequence  = read_u16(&data[6]);
+    snapshot->uptime_ms = read_u32(&data[8]);
+    for (uint8_t i = 0U; i < count; i++)
+    {
+        snapshot->values[first + i] = read_u32(&data[sizeof(APP_METRICS_HEADER) + (i * sizeof(uint32_t))]);
+    }
+
+    return first + count;
+}
+
+/* Reads all metrics, in several requests if one response does not hold them */
+static int query(int fd, uint16_t interface, query_snapshot_t* snapshot)
+{
+    static uint8_t response[QUERY_MAX_SIZE];
+    int            next = 0;
+
+    do
+    {
+        struct usbdevfs_ctrltransfer transfer =
+        {
+            .bRequestType = APP_METRICS_REQUEST_TYPE,
+            .bRequest     = APP_METRICS_REQ_SNAPSHOT,
+            .wValue       = (uint16_t)next,
+            .wIndex       = interface,
+            .wLength      = sizeof(response),
+            .timeout      = QUERY_TIMEOUT_MS,
+            .data         = response
+        };
+        int length = ioctl(fd, USBDEVFS_CONTROL, &transfer);
+        int first = next;
+
+        if (length < 0)
+        {
+            fprintf(stderr, "Snapshot request failed: %s\n", strerror(errno));
+            return -1;
+        }
+
+        next = decode(response, (size_t)length, snapshot);
+        if ((next < 0) || (next == first))
+        {
+            return -1;
+        }
+    } while (next < snapshot->total);
+
+    return 0;
+}
+
+static int read_file(const char* path, query_snapshot_t* snapshot)
+{
+    static uint8_t data[QUERY_MAX_SIZE];
+    FILE*          file = fopen(path, "rb");
+    size_t         length;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+    length = fread(data, 1U, sizeof(data), file);
+    fclose(file);
+
+    if (decode(data, length, snapshot) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Searches the usbfs node of the first board in device role */
+static int find_device(char* path, size_t size)
+{
+    DIR*           dir = opendir("/sys/bus/usb/devices");
+    struct dirent* entry;
+    int            found = -1;
+
+    if (dir == NULL)
+    {
+        return -1;
+    }
+
+    while ((found < 0) && ((entry = readdir(dir)) != NULL))
+    {
+        unsigned int vid = 0U, pid = 0U, bus = 0U, dev = 0U;
+        char         name[512];
+        FILE*        file;
+
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "/sys/bus/usb/devices/%s/uevent", entry->d_name);
+        file = fopen(name, "r");
+        if (file == NULL)
+        {
+            continue;
+        }
+        while (fgets(name, sizeof(name), file) != NULL)
+        {
+            sscanf(name, "PRODUCT=%x/%x/", &vid, &pid);
+            sscanf(name, "BUSNUM=%u", &bus);
+            sscanf(name, "DEVNUM=%u", &dev);
+        }
+        fclose(file);
+
+        if ((vid == QUERY_VENDOR_ID) && (pid == QUERY_PRODUCT_ID) && (bus != 0U))
+        {
+            snprintf(path, size, "/dev/bus/usb/%03u/%03u", bus, dev);
+            found = 0;
+        }
+    }
+    closedir(dir);
+
+    return found;
+}
+
+static void print_snapshot(const query_snapshot_t* snapshot, const query_snapshot_t* previous)
+{
+    uint32_t elapsed_ms = 0U;
+
+    if (previous != NULL)
+    {
+        elapsed_ms = snapshot->uptime_ms - previous->uptime_ms;
+    }
+
+    printf("uptime %u.%03u s, snapshot %u\n", snapshot->uptime_ms / 1000U, snapshot->uptime_ms % 1000U,
+           snapshot->sequence);
+    if (snapshot->total != APP_METRIC_COUNT)
+    {
+        printf("  firmware has %u metrics, tool knows %u\n", snapshot->total, APP_METRIC_COUNT);
+    }
+
+    for (uint32_t i = 0U; i < snapshot->total; i++)
+    {
+        char name[64];
+        int  type = APP_METRIC_TYPE_COUNTER;
+
+        if (i < APP_METRIC_COUNT)
+        {
+            snprintf(name, sizeof(name), "%s.%s", query_metrics[i].module, query_metrics[i].name);
+            type = query_metrics[i].type;
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "metric[%u]", i);
+        }
+
+        if ((type == APP_METRIC_TYPE_COUNTER) && (elapsed_ms != 0U))
+        {
+            /* Unsigned difference, correct across a wrap of the counter */
+            uint32_t delta = snapshot->values[i] - previous->values[i];
+
+            printf("  %-28s %10u  %10.1f/s\n", name, snapshot->values[i], (delta * 1000.0) / elapsed_ms);
+        }
+        else
+        {
+            printf("  %-28s %10u%s\n", name, snapshot->values[i],
+                   (type == APP_METRIC_TYPE_GAUGE) ? "  (gauge)" : "");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    query_snapshot_t snapshot;
+    query_snapshot_t previous;
+    char             device[64] = "";
+    const char*      raw = NULL;
+    uint16_t         interface = APP_METRICS_INTERFACE;
+    uint32_t         watch_ms = 0U;
+    int              fd;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-d") == 0) && ((i + 1) < argc))
+        {
+            snprintf(device, sizeof(device), "%s", argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-I") == 0) && ((i + 1) < argc))
+        {
+            interface = (uint16_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-w") == 0) && ((i + 1) < argc))
+        {
+            watch_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-r") == 0) && ((i + 1) < argc))
+        {
+            raw = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-d <usbfs path>] [-I <interface>] [-w <ms>]\n"
+                            "       %s -r <snapshot file>\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    if (raw != NULL)
+    {
+        if (read_file(raw, &snapshot) != 0)
+        {
+            return 2;
+        }
+        print_snapshot(&snapshot, NULL);
+        return 0;
+    }
+
+    if ((device[0] == '\0') && (find_device(device, sizeof(device)) != 0))
+    {
+        fprintf(stderr, "No device %04X:%04X found, is the board in device role?\n",
+                QUERY_VENDOR_ID, QUERY_PRODUCT_ID);
+        return 2;
+    }
+
+    fd = open(device, O_RDWR);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cannot open %s: %s\n", device, strerror(errno));
+        return 2;
+    }
+
+    if (query(fd, interface, &snapshot) != 0)
+    {
+        close(fd);
+        return 2;
+    }
+    print_snapshot(&snapshot, NULL);
+
+    while (watch_ms != 0U)
+    {
+        usleep(watch_ms * 1000U);
+
+        previous = snapshot;
+        if (query(fd, interface, &snapshot) != 0)
+        {
+            close(fd);
+            return 2;
+        }
+        printf("\n");
+        print_snapshot(&snapshot, &previous);
+    }
+
+    close(fd);
+    return 0;
+}
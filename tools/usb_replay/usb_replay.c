@@ -0,0 +1,561 @@
+/*********************************************************************************
+* File Name        :   usb_replay.c
+*
+* Description      :   Host (Linux) replay driver for traces recorded with
+*                      USB_TRACE_ENABLE=1. Feeds the recorded emUSB calls back
+*                      through the echo processing of the firmware (cdc_stream.c)
+*                      and reports timing and allocation statistics.
+*
+* Related Document :   See README.md
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*
+ * Build:   gcc -O2 -Wall -I../../source -o usb_replay usb_replay.c ../../source/cdc_stream.c \
+ *                   ../../source/stream_kernels.c
+ * Usage:   usb_replay [-r] [-s <stage>] <trace file>
+ *
+ * The trace file is either the terminal log containing the "UTRC:" lines
+ * printed by usb_trace_dump(), or a raw binary image of the trace buffer
+ * saved with the debugger.
+ *
+ *   -r     Replay in real time, i.e. sleep for the recorded delay before
+ *          each call instead of replaying as fast as possible.
+ *   -s     Stream processing stage the firmware was built with (CDC_STREAM):
+ *          none, bswap32, checksum, slip or cobs. Default is none.
+ *
+ * The tool exits with a non-zero status if the application output produced
+ * during replay does not match the recorded output, so it can be used as a
+ * regression check.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cdc_stream.h"
+#include "stream_kernels.h"
+#include "usb_trace_format.h"
+
+/* Largest trace accepted by the tool */
+#define REPLAY_MAX_TRACE_SIZE       (1024U * 1024U)
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+} replay_stat_t;
+
+typedef struct
+{
+    uint32_t        sessions;
+    uint32_t        records;
+    uint32_t        rx_packets;
+    uint64_t        rx_bytes;
+    uint32_t        tx_packets;
+    uint64_t        tx_bytes;
+    uint32_t        mismatches;
+    uint32_t        unchecked;
+    uint32_t        errors;
+    uint32_t        device_events;
+    uint32_t        allocs;
+    uint64_t        alloc_bytes;
+    uint32_t        frees;
+    replay_stat_t   echo_latency_us;    /* Recorded: receive -> write on the device */
+    replay_stat_t   round_trip_us;      /* Recorded: write -> read on the host */
+    replay_stat_t   process_ns;         /* Measured: application logic during replay */
+} replay_summary_t;
+
+/* Expected output of the application logic, compared against the next write */
+static uint8_t  pending_data[USB_TRACE_MAX_PAYLOAD];
+static uint32_t pending_len;
+static int      pending_valid;
+static int      pending_unchecked;
+static uint64_t pending_time_us;
+
+static void stat_add(replay_stat_t* stat, uint32_t value)
+{
+    if ((stat->count == 0U) || (value < stat->min))
+    {
+        stat->min = value;
+    }
+    if (value > stat->max)
+    {
+        stat->max = value;
+    }
+    stat->sum += value;
+    stat->count++;
+}
+
+static void stat_print(const char* name, const char* unit, const replay_stat_t* stat)
+{
+    if (stat->count == 0U)
+    {
+        printf("  %-28s n/a\n", name);
+        return;
+    }
+    printf("  %-28s min %u %s, avg %llu %s, max %u %s (%u samples)\n", name,
+           stat->min, unit, (unsigned long long)(stat->sum / stat->count), unit,
+           stat->max, unit, stat->count);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t read_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/*******************************************************************************
+* Trace loading
+********************************************************************************/
+static int hex_value(int c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return c - '0';
+    }
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return c - 'A' + 10;
+    }
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/* Extracts the bytes of all "UTRC:" lines of a terminal log. Only the first
+ * trace of the log is used. */
+/* Returns the number of trace bytes, or -1 if a line of the dump is damaged,
+ * for example by other output interleaved with it */
+static long parse_hex_log(const uint8_t* text, size_t text_len, uint8_t* out, size_t out_size)
+{
+    size_t out_len = 0U;
+    size_t i = 0U;
+    size_t line_no = 0U;
+    int    started = 0;
+    int    short_line = 0;
+
+    while (i < text_len)
+    {
+        const uint8_t* line = &text[i];
+        size_t line_len = 0U;
+        size_t digits;
+
+        while (((i + line_len) < text_len) && (line[line_len] != '\n'))
+        {
+            line_len++;
+        }
+        i += line_len + 1U;
+        line_no++;
+
+        /* Terminals end lines with CR LF, some add trailing spaces */
+        while ((line_len > 0U) && ((line[line_len - 1U] == '\r') || (line[line_len - 1U] == ' ')))
+        {
+            line_len--;
+        }
+
+        if ((line_len >= 8U) && (memcmp(line, "UTRC-END", 8U) == 0) && started)
+        {
+            if (line_len != 8U)
+            {
+                fprintf(stderr, "Line %zu: trailing data after UTRC-END\n", line_no);
+                return -1;
+            }
+            break;
+        }
+        if ((line_len < 5U) || (memcmp(line, "UTRC:", 5U) != 0))
+        {
+            continue;
+        }
+
+        /* Only the last line of a dump may be shorter than a full line */
+        digits = line_len - 5U;
+        if (short_line || ((digits % 2U) != 0U) || (digits == 0U) ||
+            (digits > (2U * USB_TRACE_DUMP_LINE_BYTES)))
+        {
+            fprintf(stderr, "Line %zu: damaged trace line\n", line_no);
+            return -1;
+        }
+        short_line = (digits < (2U * USB_TRACE_DUMP_LINE_BYTES));
+
+        started = 1;
+        for (size_t j = 5U; j < line_len; j += 2U)
+        {
+            int hi = hex_value(line[j]);
+            int lo = hex_value(line[j + 1U]);
+
+            if ((hi < 0) || (lo < 0))
+            {
+                fprintf(stderr, "Line %zu: damaged trace line\n", line_no);
+                return -1;
+            }
+            if (out_len >= out_size)
+            {
+                fprintf(stderr, "Trace is too large\n");
+                return -1;
+            }
+            out[out_len++] = (uint8_t)((hi << 4) | lo);
+        }
+    }
+
+    return (long)out_len;
+}
+
+static uint8_t* load_trace(const char* path, size_t* trace_len)
+{
+    FILE*    file = fopen(path, "rb");
+    uint8_t* raw;
+    uint8_t* trace;
+    size_t   raw_len;
+
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    raw   = malloc(REPLAY_MAX_TRACE_SIZE);
+    trace = malloc(REPLAY_MAX_TRACE_SIZE);
+    if ((raw == NULL) || (trace == NULL))
+    {
+        fclose(file);
+        free(raw);
+        free(trace);
+        return NULL;
+    }
+
+    raw_len = fread(raw, 1U, REPLAY_MAX_TRACE_SIZE, file);
+    fclose(file);
+
+    if ((raw_len >= sizeof(USB_TRACE_HEADER)) && (read_u32(raw) == USB_TRACE_MAGIC))
+    {
+        memcpy(trace, raw, raw_len);
+        *trace_len = raw_len;
+    }
+    else
+    {
+        long parsed = parse_hex_log(raw, raw_len, trace, REPLAY_MAX_TRACE_SIZE);
+
+        if (parsed < 0)
+        {
+            free(raw);
+            free(trace);
+            return NULL;
+        }
+        *trace_len = (size_t)parsed;
+    }
+
+    free(raw);
+    return trace;
+}
+
+/*******************************************************************************
+* Replay
+********************************************************************************/
+static void replay_record(replay_summary_t* summary, uint8_t event, int32_t result,
+                          const uint8_t* payload, uint16_t payload_len, uint64_t time_us)
+{
+    uint8_t  buffer[STREAM_SLIP_MAX_SIZE(USB_TRACE_MAX_PAYLOAD)];
+    uint32_t length;
+    uint64_t start;
+
+    switch (event)
+    {
+        case USB_TRACE_EVT_SESSION_HOST:
+        case USB_TRACE_EVT_SESSION_DEVICE:
+            summary->sessions++;
+            pending_valid = 0;
+            break;
+
+        case USB_TRACE_EVT_USBD_CDC_RECEIVE:
+            if (result <= 0)
+            {
+                break;
+            }
+            summary->rx_packets++;
+            summary->rx_bytes += (uint32_t)result;
+
+            memcpy(buffer, payload, payload_len);
+            start = now_ns();
+            /* Same call as device_app() in otg.c */
+            length = cdc_stream_encode(buffer, payload_len, sizeof(buffer));
+            stat_add(&summary->process_ns, (uint32_t)(now_ns() - start));
+
+            /* The trace holds the first bytes of the write only */
+            pending_len = (length > USB_TRACE_MAX_PAYLOAD) ? USB_TRACE_MAX_PAYLOAD : length;
+            memcpy(pending_data, buffer, pending_len);
+            pending_valid   = 1;
+            pending_time_us = time_us;
+
+            /* A stage that transforms the data can only be checked on complete packets */
+            pending_unchecked = (cdc_stream_get_stage()->encode != NULL) && ((uint32_t)result > payload_len);
+            break;
+
+        case USB_TRACE_EVT_USBD_CDC_WRITE:
+            summary->tx_packets++;
+            if (result > 0)
+            {
+                summary->tx_bytes += (uint32_t)result;
+            }
+            if (pending_valid && pending_unchecked)
+            {
+                summary->unchecked++;
+                stat_add(&summary->echo_latency_us, (uint32_t)(time_us - pending_time_us));
+            }
+            else if (!pending_valid || (pending_len != payload_len) ||
+                     (memcmp(pending_data, payload, payload_len) != 0))
+            {
+                summary->mismatches++;
+            }
+            else
+            {
+                stat_add(&summary->echo_latency_us, (uint32_t)(time_us - pending_time_us));
+            }
+            pending_valid     = 0;
+            pending_unchecked = 0;
+            break;
+
+        case USB_TRACE_EVT_USBH_CDC_WRITE:
+            summary->tx_packets++;
+            summary->tx_bytes += payload_len;
+            if (result != 0)
+            {
+                summary->errors++;
+            }
+            /* The device on the other side is expected to echo the data */
+            memcpy(pending_data, payload, payload_len);
+            pending_len     = payload_len;
+            pending_valid   = 1;
+            pending_time_us = time_us;
+            break;
+
+        case USB_TRACE_EVT_USBH_CDC_READ:
+            if (result != 0)
+            {
+                summary->errors++;
+                pending_valid = 0;
+                break;
+            }
+            summary->rx_packets++;
+            summary->rx_bytes += payload_len;
+            if (pending_valid)
+            {
+                /* The host compares the decoded echo */
+                memcpy(buffer, payload, payload_len);
+                /* Same call as device_task() in otg.c */
+                length = cdc_stream_decode(buffer, payload_len, sizeof(buffer));
+
+                if ((pending_len != length) || (memcmp(pending_data, buffer, length) != 0))
+                {
+                    summary->mismatches++;
+                }
+                stat_add(&summary->round_trip_us, (uint32_t)(time_us - pending_time_us));
+            }
+            pending_valid = 0;
+            break;
+
+        case USB_TRACE_EVT_USBH_DEVICE_EVENT:
+            summary->device_events++;
+            break;
+
+        case USB_TRACE_EVT_ALLOC:
+            summary->allocs++;
+            summary->alloc_bytes += (uint32_t)result;
+            break;
+
+        case USB_TRACE_EVT_FREE:
+            summary->frees++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+static int replay(const uint8_t* trace, size_t trace_len, int realtime, replay_summary_t* summary)
+{
+    uint32_t length;
+    uint32_t record_count;
+    uint16_t flags;
+    size_t   offset = sizeof(USB_TRACE_HEADER);
+    uint64_t time_us = 0U;
+
+    if ((trace_len < sizeof(USB_TRACE_HEADER)) || (read_u32(trace) != USB_TRACE_MAGIC) ||
+        (read_u16(&trace[4]) != USB_TRACE_VERSION))
+    {
+        fprintf(stderr, "Not a USB trace (version %u expected)\n", USB_TRACE_VERSION);
+        return -1;
+    }
+
+    flags        = read_u16(&trace[6]);
+    length       = read_u32(&trace[8]);
+    record_count = read_u32(&trace[12]);
+
+    if ((sizeof(USB_TRACE_HEADER) + length) > trace_len)
+    {
+        fprintf(stderr, "Trace is truncated\n");
+        return -1;
+    }
+    if ((flags & USB_TRACE_FLAG_OVERFLOW) != 0U)
+    {
+        fprintf(stderr, "Warning: trace buffer overflowed on the target, trace is incomplete\n");
+    }
+
+    while ((summary->records < record_count) &&
+           ((offset + sizeof(USB_TRACE_RECORD)) <= (sizeof(USB_TRACE_HEADER) + length)))
+    {
+        const uint8_t* p = &trace[offset];
+        uint8_t  event       = p[0];
+        uint16_t payload_len = read_u16(&p[2]);
+        int32_t  result      = (int32_t)read_u32(&p[4]);
+        uint32_t delta_us    = read_u32(&p[8]);
+
+        if ((payload_len > USB_TRACE_MAX_PAYLOAD) ||
+            ((offset + sizeof(USB_TRACE_RECORD) + payload_len) > trace_len))
+        {
+            fprintf(stderr, "Corrupt record %u\n", summary->records);
+            return -1;
+        }
+
+        time_us += delta_us;
+        if (realtime && (delta_us > 0U))
+        {
+            struct timespec ts = { (time_t)(delta_us / 1000000U), (long)(delta_us % 1000000U) * 1000L };
+            nanosleep(&ts, NULL);
+        }
+
+        replay_record(summary, event, result, &p[sizeof(USB_TRACE_RECORD)], payload_len, time_us);
+
+        summary->records++;
+        offset += sizeof(USB_TRACE_RECORD) + USB_TRACE_ALIGN(payload_len);
+    }
+
+    printf("Replayed %u records covering %llu.%03llu ms\n", summary->records,
+           (unsigned long long)(time_us / 1000U), (unsigned long long)(time_us % 1000U));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    replay_summary_t summary;
+    const char* path = NULL;
+    uint8_t*    trace;
+    size_t      trace_len = 0U;
+    int         realtime = 0;
+    int         status;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0)
+        {
+            realtime = 1;
+        }
+        else if ((strcmp(argv[i], "-s") == 0) && ((i + 1) < argc))
+        {
+            const cdc_stream_stage_t* stage = cdc_stream_find_stage(argv[++i]);
+
+            if (stage == NULL)
+            {
+                fprintf(stderr, "Unknown stage %s\n", argv[i]);
+                return 2;
+            }
+            cdc_stream_set_stage(stage);
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "Usage: %s [-r] [-s <stage>] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    trace = load_trace(path, &trace_len);
+    if (trace == NULL)
+    {
+        return 2;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    status = replay(trace, trace_len, realtime, &summary);
+    free(trace);
+
+    if (status != 0)
+    {
+        return 2;
+    }
+
+    printf("  %-28s %u\n", "sessions", summary.sessions);
+    printf("  %-28s %u packets, %llu bytes\n", "received", summary.rx_packets,
+           (unsigned long long)summary.rx_bytes);
+    printf("  %-28s %u packets, %llu bytes\n", "sent", summary.tx_packets,
+           (unsigned long long)summary.tx_bytes);
+    printf("  %-28s %u\n", "device events", summary.device_events);
+    printf("  %-28s %u\n", "failed calls", summary.errors);
+    printf("  %-28s %u allocations (%llu bytes), %u frees\n", "heap", summary.allocs,
+           (unsigned long long)summary.alloc_bytes, summary.frees);
+    stat_print("echo latency (recorded)", "us", &summary.echo_latency_us);
+    stat_print("round trip (recorded)", "us", &summary.round_trip_us);
+    stat_print("app processing (replay)", "ns", &summary.process_ns);
+    printf("  %-28s %u\n", "output mismatches", summary.mismatches);
+    if (summary.unchecked != 0U)
+    {
+        printf("  %-28s %u\n", "unchecked (truncated)", summary.unchecked);
+    }
+
+    return (summary.mismatches == 0U) ? 0 : 1;
+}